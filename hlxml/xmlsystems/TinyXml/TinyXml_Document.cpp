@@ -50,7 +50,7 @@ namespace hlxml
 	TinyXml_Document::~TinyXml_Document()
 	{
 		this->rootNode = NULL;
-		foreach_map (TiXmlNode*, TinyXml_Node*, it, this->nodes)
+		foreach_flat_map (TiXmlNode*, TinyXml_Node*, it, this->nodes)
 		{
 			delete it->second;
 		}
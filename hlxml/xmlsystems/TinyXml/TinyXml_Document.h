@@ -18,7 +18,7 @@
 class TiXmlDocument;
 class TiXmlNode;
 
-#include <hltypes/hmap.h>
+#include <hltypes/hflathashmap.h>
 #include <hltypes/hstring.h>
 
 #include "Document.h"
@@ -41,7 +41,7 @@ namespace hlxml
 	protected:
 		TiXmlDocument* document;
 		TinyXml_Node* rootNode;
-		hmap<TiXmlNode*, TinyXml_Node*> nodes;
+		hflathashmap<TiXmlNode*, TinyXml_Node*> nodes;
 		
 	};
 
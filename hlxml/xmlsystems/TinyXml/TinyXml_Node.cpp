@@ -28,7 +28,7 @@ namespace hlxml
 
 	TinyXml_Node::~TinyXml_Node()
 	{
-		foreach_map (TiXmlAttribute*, TinyXml_Property*, it, this->props)
+		foreach_flat_map (TiXmlAttribute*, TinyXml_Property*, it, this->props)
 		{
 			delete it->second;
 		}
@@ -96,11 +96,12 @@ namespace hlxml
 		{
 			return NULL;
 		}
-		if (!this->props.has_key(prop))
+		TinyXml_Property*& result = this->props[prop];
+		if (result == NULL)
 		{
-			this->props[prop] = new TinyXml_Property(this, prop);
+			result = new TinyXml_Property(this, prop);
 		}
-		return this->props[prop];
+		return result;
 	}
 
 	bool TinyXml_Node::_equals(const char* name)
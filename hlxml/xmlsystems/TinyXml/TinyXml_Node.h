@@ -15,7 +15,7 @@
 #ifndef HLXML_TINYXML_NODE_H
 #define HLXML_TINYXML_NODE_H
 
-#include <hltypes/hmap.h>
+#include <hltypes/hflathashmap.h>
 #include <hltypes/hstring.h>
 
 #include "hlxmlExport.h"
@@ -51,7 +51,7 @@ namespace hlxml
 	protected:
 		TinyXml_Document* document;
 		TiXmlNode* node;
-		hmap<TiXmlAttribute*, TinyXml_Property*> props;
+		hflathashmap<TiXmlAttribute*, TinyXml_Property*> props;
 
 		const char* _findProperty(chstr propertyName, bool ignoreError = false);
 		bool _equals(const char* name);
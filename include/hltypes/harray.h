@@ -35,6 +35,130 @@
 
 namespace hltypes
 {
+	/// @brief Describes whether elements of a type can be ordered with operator<.
+	/// @note Set operations like Array::remove_duplicates() and Array::intersect() sort element lookups for these types instead of
+	/// comparing every element with every other one. Specialize this for own types that implement a strict weak ordering with operator<.
+	/// @note Floating point types are not orderable since operator< is not a strict weak ordering if NaN values are present.
+	template <class T> struct ArrayElementOrder
+	{
+		enum { orderable = 0 };
+	};
+	template <class T> struct ArrayElementOrder<T*>
+	{
+		enum { orderable = 1 };
+	};
+/// @brief Internal provider for declaring orderable element types.
+#define __hltypes_array_orderable(type) template <> struct ArrayElementOrder<type> { enum { orderable = 1 }; };
+	__hltypes_array_orderable(char)
+	__hltypes_array_orderable(unsigned char)
+	__hltypes_array_orderable(short)
+	__hltypes_array_orderable(unsigned short)
+	__hltypes_array_orderable(int)
+	__hltypes_array_orderable(unsigned int)
+	__hltypes_array_orderable(long)
+	__hltypes_array_orderable(unsigned long)
+	__hltypes_array_orderable(long long)
+	__hltypes_array_orderable(unsigned long long)
+	__hltypes_array_orderable(String)
+#undef __hltypes_array_orderable
+
+	/// @brief Internal helper for membership tests and duplicate removal in Array set operations.
+	/// @note This version only requires operator== and compares elements linearly.
+	template <class T, int orderable = ArrayElementOrder<T>::orderable> class ArrayElementLookup
+	{
+	public:
+		ArrayElementLookup(const std::vector<T>& elements) : elements(elements)
+		{
+		}
+		bool contains(const T& element) const
+		{
+			return (std::find(this->elements.begin(), this->elements.end(), element) != this->elements.end());
+		}
+		/// @brief Gets the indexes of all first occurrences of elements in their original order.
+		static void unique_indexes(const std::vector<T>& elements, std::vector<int>& indexes)
+		{
+			int count = (int)elements.size();
+			std::vector<T> unique;
+			for_iter (i, 0, count)
+			{
+				if (std::find(unique.begin(), unique.end(), elements[i]) == unique.end())
+				{
+					unique.push_back(elements[i]);
+					indexes.push_back(i);
+				}
+			}
+		}
+
+	protected:
+		const std::vector<T>& elements;
+
+	};
+
+	/// @brief Internal helper for membership tests and duplicate removal in Array set operations.
+	/// @note This version sorts pointers to the elements and uses binary search.
+	template <class T> class ArrayElementLookup<T, 1>
+	{
+	public:
+		ArrayElementLookup(const std::vector<T>& elements)
+		{
+			int count = (int)elements.size();
+			this->sorted.reserve(count);
+			for_iter (i, 0, count)
+			{
+				this->sorted.push_back(&elements[i]);
+			}
+			std::sort(this->sorted.begin(), this->sorted.end(), &_less);
+		}
+		bool contains(const T& element) const
+		{
+			return std::binary_search(this->sorted.begin(), this->sorted.end(), &element, &_less);
+		}
+		/// @brief Gets the indexes of all first occurrences of elements in their original order.
+		static void unique_indexes(const std::vector<T>& elements, std::vector<int>& indexes)
+		{
+			int count = (int)elements.size();
+			std::vector<int> order(count);
+			for_iter (i, 0, count)
+			{
+				order[i] = i;
+			}
+			// stable sorting keeps the first occurrence of equal elements in front
+			std::stable_sort(order.begin(), order.end(), IndexLess(elements));
+			std::vector<bool> keep(count, false);
+			for_iter (i, 0, count)
+			{
+				if (i == 0 || elements[order[i - 1]] < elements[order[i]])
+				{
+					keep[order[i]] = true;
+				}
+			}
+			for_iter (i, 0, count)
+			{
+				if (keep[i])
+				{
+					indexes.push_back(i);
+				}
+			}
+		}
+
+	protected:
+		/// @brief Compares elements by their indexes.
+		struct IndexLess
+		{
+			const std::vector<T>& elements;
+			IndexLess(const std::vector<T>& elements) : elements(elements) { }
+			bool operator()(int a, int b) const { return (this->elements[a] < this->elements[b]); }
+		};
+
+		std::vector<const T*> sorted;
+
+		static bool _less(const T* a, const T* b)
+		{
+			return (*a < *b);
+		}
+
+	};
+
 	/// @brief Encapsulates std::vector and adds high level methods.
 	template <class T> class Array : public stdvector
 	{
@@ -418,33 +542,19 @@ namespace hltypes
 		/// @return Number of elements removed.
 		int remove_all(const T& element)
 		{
-			Array<int> indexes = this->indexes_of(element);
-			iterator_t it = stdvector::begin();
-			for_iter_r (i, indexes.size(), 0)
-			{
-				stdvector::erase(it + indexes[i]);
-			}
-			return indexes.size();
+			int size = this->size();
+			T value = element; // element could be a reference into this Array that std::remove would overwrite
+			stdvector::erase(std::remove(stdvector::begin(), stdvector::end(), value), stdvector::end());
+			return (size - this->size());
 		}
 		/// @brief Removes all occurrences of each element in another Array from this one.
 		/// @param[in] other Array of elements to remove.
 		/// @return Number of elements removed.
 		int remove_all(const Array<T>& other)
 		{
-			Array<int> indexes;
-			iterator_t it;
-			int count = 0;
-			for_iter (i, 0, other.size())
-			{
-				indexes = this->indexes_of(other.at(i));
-				it = stdvector::begin();
-				for_iter_r (j, indexes.size(), 0)
-				{
-					stdvector::erase(it + indexes[j]);
-				}
-				count += indexes.size();
-			}
-			return count;
+			int size = this->size();
+			this->_keep_contained(other, false);
+			return (size - this->size());
 		}
 		/// @brief Adds element at the end of Array.
 		/// @param[in] element Element to add.
@@ -630,15 +740,7 @@ namespace hltypes
 		/// @param[in] other Array to intersect with.
 		void intersect(const Array<T>& other)
 		{
-			Array<T> result;
-			for_iter (i, 0, this->size())
-			{
-				if (other.contains(stdvector::at(i)))
-				{
-					result.push_back(stdvector::at(i));
-				}
-			}
-			stdvector::assign(result.begin(), result.end());
+			this->_keep_contained(other, true);
 		}
 		/// @brief Creates a new Array as intersection of this Array with another one.
 		/// @param[in] other Array to intersect with.
@@ -654,35 +756,15 @@ namespace hltypes
 		/// @note Unlike remove, this method ignores if the element is not in this Array.
 		void differentiate(const T& element)
 		{
-			int index = 0;
-			while (true)
-			{
-				index = this->index_of(element);
-				if (index < 0)
-				{
-					break;
-				}
-				stdvector::erase(stdvector::begin() + index);
-			}
+			T value = element; // element could be a reference into this Array that std::remove would overwrite
+			stdvector::erase(std::remove(stdvector::begin(), stdvector::end(), value), stdvector::end());
 		}
 		/// @brief Differentiates elements of this Array with another one.
 		/// @param[in] other Array to differentiate with.
 		/// @note Unlike remove, this method ignore elements of other Array that are not in this one.
 		void differentiate(const Array<T>& other)
 		{
-			int index;
-			for_iter (i, 0, other.size())
-			{
-				while (true)
-				{
-					index = this->index_of(other.at(i));
-					if (index < 0)
-					{
-						break;
-					}
-					stdvector::erase(stdvector::begin() + index);
-				}
-			}
+			this->_keep_contained(other, false);
 		}
 		/// @brief Creates a new Array as difference of this Array with an element.
 		/// @param[in] other Element to differentiate with.
@@ -721,17 +803,28 @@ namespace hltypes
 			return result;
 		}
 		/// @brief Removes duplicates in Array.
+		/// @note The first occurrence of every element is kept and the order of elements does not change.
 		void remove_duplicates()
 		{
-			Array<int> indexes;
-			iterator_t it = stdvector::begin();
-			for_iter (i, 0, this->size())
+			int size = this->size();
+			if (size < 2)
+			{
+				return;
+			}
+			std::vector<int> indexes;
+			ArrayElementLookup<T>::unique_indexes(*this, indexes);
+			int count = (int)indexes.size();
+			if (count < size)
 			{
-				indexes = this->indexes_of(stdvector::at(i));
-				for_iter_r (j, indexes.size(), 1)
+				// indexes are ascending so elements can be moved forward in place
+				for_iter (i, 0, count)
 				{
-					stdvector::erase(it + indexes[j]);
+					if (indexes[i] != i)
+					{
+						stdvector::at(i) = stdvector::at(indexes[i]);
+					}
 				}
+				stdvector::erase(stdvector::begin() + count, stdvector::end());
 			}
 		}
 		/// @brief Creates new Array without duplicates.
@@ -1533,6 +1626,48 @@ namespace hltypes
 			return this->differentiated(other);
 		}
 		
+	protected:
+		/// @brief Keeps only elements that are or are not contained in another Array.
+		/// @param[in] other The other Array.
+		/// @param[in] contained Whether contained or not contained elements are kept.
+		/// @note The order of kept elements does not change.
+		void _keep_contained(const Array<T>& other, bool contained)
+		{
+			int size = this->size();
+			int otherSize = other.size();
+			if (size == 0)
+			{
+				return;
+			}
+			Array<T> result;
+			result.reserve(contained ? hmin(size, otherSize) : size);
+			if (otherSize <= 8 || size <= 8)
+			{
+				// small arrays are faster to search linearly
+				const_iterator_t begin = other.begin();
+				const_iterator_t end = other.end();
+				for_iter (i, 0, size)
+				{
+					if ((std::find(begin, end, stdvector::at(i)) != end) == contained)
+					{
+						result.push_back(stdvector::at(i));
+					}
+				}
+			}
+			else
+			{
+				ArrayElementLookup<T> lookup(other);
+				for_iter (i, 0, size)
+				{
+					if (lookup.contains(stdvector::at(i)) == contained)
+					{
+						result.push_back(stdvector::at(i));
+					}
+				}
+			}
+			stdvector::swap(result);
+		}
+
 	};
 	
 }
@@ -0,0 +1,62 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+/// 
+/// @section DESCRIPTION
+/// 
+/// Provides functionality of a condition variable for multithreading.
+
+#ifndef HLTYPES_CONDITION_H
+#define HLTYPES_CONDITION_H
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "hltypesExport.h"
+
+namespace hltypes
+{
+	/// @brief Provides functionality of a condition variable for multithreading.
+	/// @note The Condition has its own lock that has to be locked while waiting and while changing the state that is waited for.
+	/// @note Requires Windows Vista or later on Windows.
+	class hltypesExport Condition
+	{
+	public:
+		/// @brief Basic constructor.
+		Condition();
+		/// @brief Destructor.
+		~Condition();
+		/// @brief Locks the Condition's lock.
+		void lock();
+		/// @brief Unlocks the Condition's lock.
+		void unlock();
+		/// @brief Waits until the Condition is signaled.
+		/// @param[in] timeout Maximum time to wait in miliseconds. If 0 or less, waits without a timeout.
+		/// @return False if the timeout expired.
+		/// @note The Condition has to be locked when calling this. It is unlocked while waiting and locked again before returning.
+		/// @note Waiting can end without a signal so the waited for state should always be checked in a loop.
+		bool wait(float timeout = 0.0f);
+		/// @brief Wakes up one waiting thread.
+		void signal();
+		/// @brief Wakes up all waiting threads.
+		void broadcast();
+
+	protected:
+		/// @brief Lock OS handle.
+		void* handle;
+		/// @brief Condition variable OS handle.
+		void* condition;
+
+	};
+}
+
+/// @brief Alias for simpler code.
+typedef hltypes::Condition hcondition;
+
+#endif
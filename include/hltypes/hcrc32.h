@@ -0,0 +1,56 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+/// 
+/// @section DESCRIPTION
+/// 
+/// Provides incremental CRC32 calculation.
+
+#ifndef HLTYPES_CRC32_H
+#define HLTYPES_CRC32_H
+
+#include "hltypesExport.h"
+
+namespace hltypes
+{
+	/// @brief Provides incremental CRC32 calculation.
+	/// @note Uses the same polynomial as ZIP and zlib.
+	/// @note Uses carry-less multiplication on x86 and CRC32 instructions on ARMv8 if the CPU supports them.
+	class hltypesExport Crc32
+	{
+	public:
+		/// @brief Basic constructor.
+		Crc32();
+		/// @brief Destructor.
+		~Crc32();
+		/// @brief Starts a new calculation.
+		void reset();
+		/// @brief Adds data to the calculation.
+		/// @param[in] data Data buffer.
+		/// @param[in] size Size of the data buffer in bytes.
+		void update(const unsigned char* data, long size);
+		/// @brief Gets the CRC32 value of all data added so far.
+		/// @return CRC32 value.
+		/// @note More data can still be added afterwards.
+		unsigned int final();
+
+		/// @brief Checks whether a hardware accelerated implementation is used.
+		/// @return True if a hardware accelerated implementation is used.
+		static bool isAccelerated();
+
+	protected:
+		/// @brief Current internal CRC32 value.
+		unsigned int crc;
+
+	};
+}
+
+/// @brief Alias for simpler code.
+typedef hltypes::Crc32 hcrc32;
+
+#endif
@@ -21,10 +21,75 @@
 
 namespace hltypes
 {
+	/// @brief Used for information about directory entries.
+	struct hltypesExport DirEntry
+	{
+		/// @brief Defines types of directory entries.
+		enum Type
+		{
+			/// @brief A regular file or a symbolic link to one.
+			REGULAR_FILE,
+			/// @brief A directory or a symbolic link to one.
+			DIRECTORY,
+			/// @brief Anything else, e.g. a broken symbolic link or a device.
+			OTHER
+		};
+
+		/// @brief Name of the entry.
+		String name;
+		/// @brief Type of the entry.
+		Type type;
+		/// @brief Whether the entry is a symbolic link.
+		/// @note On Windows this is true for all reparse points, e.g. junctions.
+		bool link;
+		/// @brief File size.
+		/// @note Only set if information was requested.
+		/// @note Only files up to 4 GB for now.
+		unsigned long size;
+		/// @brief The time the entry was last modified.
+		/// @note Only set if information was requested.
+		unsigned long modification_time;
+
+		/// @brief Constructor.
+		DirEntry();
+		/// @brief Destructor.
+		~DirEntry();
+
+	};
+
+	/// @brief Used for configuring recursive directory walks.
+	struct hltypesExport DirWalkOptions
+	{
+		/// @brief Maximum depth of entered subdirectories.
+		/// @note 0 only lists the given directory. Negative values mean that there is no limit.
+		int max_depth;
+		/// @brief Whether symbolic links to directories are entered.
+		/// @note Links that lead back to a directory that is currently being walked are never entered.
+		bool follow_links;
+		/// @brief Whether size and modification time should be read as well.
+		bool with_info;
+		/// @brief Whether subdirectories are walked on multiple threads.
+		/// @note Uses the ThreadPool of Parallel. The order of entries is not defined in this case.
+		bool parallel;
+		/// @brief Function pointer with filter function that takes an entry and returns bool.
+		/// @note Entries for which the filter returns false are skipped and directories are not entered.
+		/// @note In parallel walks the filter is called from multiple threads at the same time.
+		bool (*filter)(const DirEntry& entry);
+
+		/// @brief Constructor.
+		DirWalkOptions();
+		/// @brief Destructor.
+		~DirWalkOptions();
+
+	};
+
 	template <class T> class Array;
 	/// @brief Provides high level directory handling.
 	class hltypesExport Dir : public DirBase
 	{
+		friend class DirWatch;
+		friend class FileBase;
+
 	public:
 		/// @brief Sets flag for creating directories with full access permissions on Win32 (Vista and later).
 		/// @return flag for creating directories with full access permissions on Win32 (Vista and later)
@@ -32,6 +97,14 @@ namespace hltypes
 		/// @brief Sets flag for creating directories with full access permissions on Win32 (Vista and later).
 		/// @param[in] value New value.
 		static void setWin32FullDirectoryPermissions(bool value) { win32FullDirectoryPermissions = value; }
+		/// @brief Gets flag for caching directory listings of case insensitive existence checks.
+		/// @return flag for caching directory listings of case insensitive existence checks
+		static bool getCaseInsensitiveCache() { return caseInsensitiveCache; }
+		/// @brief Sets flag for caching directory listings of case insensitive existence checks.
+		/// @param[in] value New value.
+		/// @note Cached listings are checked against the modification time of their directory on every use.
+		/// @note Disabling the cache also clears it.
+		static void setCaseInsensitiveCache(bool value);
 
 		/// @brief Creates a directory.
 		/// @param[in] dirname Name of the directory.
@@ -43,18 +116,24 @@ namespace hltypes
 		static bool create_new(const String& dirname);
 		/// @brief Removes a directory.
 		/// @param[in] dirname Name of the directory.
+		/// @param[in] parallel Whether files are removed on multiple threads.
 		/// @return True if directory exists and was removed.
-		static bool remove(const String& dirname);
+		/// @note In parallel mode symbolic links to directories are removed without removing the contents of their targets.
+		/// @note Parallel mode uses the ThreadPool of Parallel and can be used from tasks that run on that ThreadPool.
+		static bool remove(const String& dirname, bool parallel = false);
 		/// @brief Checks if a directory exists.
 		/// @param[in] dirname Name of the directory.
 		/// @param[in] case_sensitive Whether to check case sensitive files if file was not found.
 		/// @return True if directory exists.
-		/// @note Disabling case_sensitive is somewhat costly if the given file is not found at first.
+		/// @note Disabling case_sensitive is somewhat costly if the given file is not found at first, unless the case insensitive cache is enabled.
 		static bool exists(const String& dirname, bool case_sensitive = true);
 		/// @brief Clears a directory recursively.
 		/// @param[in] dirname Name of the directory.
+		/// @param[in] parallel Whether files are removed on multiple threads.
 		/// @return True if directory was cleared. False if directory does not exist or is already empty.
-		static bool clear(const String& dirname);
+		/// @note In parallel mode symbolic links to directories are removed without removing the contents of their targets.
+		/// @note Parallel mode uses the ThreadPool of Parallel and can be used from tasks that run on that ThreadPool.
+		static bool clear(const String& dirname, bool parallel = false);
 		/// @brief Renames a directory.
 		/// @param[in] old_dirname Old name of the directory.
 		/// @param[in] new_dirname New name of the directory.
@@ -70,9 +149,36 @@ namespace hltypes
 		/// @brief Copies a directory recursively.
 		/// @param[in] old_dirname Old name of the directory.
 		/// @param[in] new_dirname New name of the directory.
+		/// @param[in] parallel Whether files are copied on multiple threads.
 		/// @return True if directory was copied. False if old directory does not exist or directory with the new name already exists.
 		/// @note If path does not exist, it will be created.
-		static bool copy(const String& old_dirname, const String& new_dirname);
+		/// @note Parallel mode uses the ThreadPool of Parallel and mostly pays off with many small files or fast storage. It can be used
+		/// from tasks that run on that ThreadPool.
+		static bool copy(const String& old_dirname, const String& new_dirname, bool parallel = false);
+		/// @brief Reads all entries in the given directory together with their types in one pass.
+		/// @param[in] dirname Name of the directory.
+		/// @param[in] with_info Whether size and modification time should be read as well.
+		/// @return Array of all directory entries.
+		/// @note Entries do not include "." and "..".
+		/// @note Listings of directories that are watched with DirWatch are cached.
+		/// @note Types are taken from the directory listing itself where possible so entries usually don't have to be opened or checked
+		/// separately. Only symbolic links, entries on file systems that don't report types and with_info require a stat call per entry.
+		static Array<DirEntry> scan(const String& dirname, bool with_info = false);
+		/// @brief Walks through all entries in the given directory and its subdirectories.
+		/// @param[in] dirname Name of the directory.
+		/// @param[in] options Options for the walk.
+		/// @return Array of all entries. Their names are paths relative to dirname.
+		/// @note Entries do not include "." and "..".
+		static Array<DirEntry> walk(const String& dirname, const DirWalkOptions& options = DirWalkOptions());
+		/// @brief Walks through all entries in the given directory and its subdirectories.
+		/// @param[in] dirname Name of the directory.
+		/// @param[in] callback Function pointer with function that takes an entry and the argument and is called for every entry.
+		/// @param[in] argument Argument that is passed to the callback.
+		/// @param[in] options Options for the walk.
+		/// @note Names of the entries are paths relative to dirname.
+		/// @note The callback is never called from multiple threads at the same time, even in parallel walks.
+		/// @note Directories are opened relative to their parent directory where possible so paths don't have to be resolved again.
+		static void walk(const String& dirname, void (*callback)(const DirEntry& entry, void* argument), void* argument, const DirWalkOptions& options = DirWalkOptions());
 		/// @brief Gets all directory entries in the given directory.
 		/// @param[in] dirname Name of the directory.
 		/// @param[in] prepend_dir Whether the same parent path should be appended to the entries.
@@ -101,6 +207,9 @@ namespace hltypes
 		/// @brief Gets the current working directory.
 		/// @return Current working directory.
 		static String cwd();
+		/// @brief Clears all cached directory listings of case insensitive existence checks.
+		/// @note Only needed if directories can change without their modification time changing, e.g. on some network file systems.
+		static void clear_case_insensitive_cache();
 
 		/// @brief Creates the parent path of the given directory or file.
 		/// @param[in] path Path of a directory or file.
@@ -123,12 +232,34 @@ namespace hltypes
 
 		/// @brief Flag for creating directories with full access permissions on Win32 (Vista and later).
 		static bool win32FullDirectoryPermissions;
+		/// @brief Flag for caching directory listings of case insensitive existence checks.
+		static bool caseInsensitiveCache;
+
+		/// @brief Checks if a file or directory exists with a single system call.
+		/// @param[in] name Normalized name of the file or directory.
+		/// @param[in] directory Whether a directory or a file is checked.
+		/// @return True if the entry exists and has the requested type.
+		static bool _exists(const String& name, bool directory);
+		/// @brief Finds an entry in a directory regardless of case.
+		/// @param[in] dirname Normalized name of the directory.
+		/// @param[in] basename Name of the entry.
+		/// @param[in] directory Whether a directory or a file is searched.
+		/// @return Full path of the entry with its actual case or an empty String if it was not found.
+		static String _find_case_insensitive(const String& dirname, const String& basename, bool directory);
+		/// @brief Drops all cached listings of a directory.
+		/// @param[in] dirname Normalized name of the directory.
+		/// @note Called by DirWatch when a watched directory changed.
+		static void _invalidate(const String& dirname);
 
 	};
 }
 
 /// @brief Alias for simpler code.
 typedef hltypes::Dir hdir;
+/// @brief Alias for simpler code.
+typedef hltypes::DirEntry hdirentry;
+/// @brief Alias for simpler code.
+typedef hltypes::DirWalkOptions hdirwalkoptions;
 
 #endif
 
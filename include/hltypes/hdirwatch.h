@@ -0,0 +1,84 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+/// 
+/// @section DESCRIPTION
+/// 
+/// Provides tracking of changes in directories.
+
+#ifndef HLTYPES_DIR_WATCH_H
+#define HLTYPES_DIR_WATCH_H
+
+#include "hstring.h"
+#include "hltypesExport.h"
+
+namespace hltypes
+{
+	/// @brief Provides tracking of changes in directories.
+	/// @note Listings of watched directories are cached by Dir so repeated listings of hot directories don't have to read them again.
+	/// A cached listing is dropped as soon as anything in its directory changes, including sizes and modification times of its files.
+	/// @note Changes are only noticed by update() which is called by every cached Dir operation. Changes made by the calling
+	/// process itself are always noticed before its next cached Dir operation.
+	/// @note Directories are identified by the given path. Relative paths should only be watched while the working directory
+	/// doesn't change.
+	/// @note Only supported on Linux (inotify) for now. On other platforms nothing is watched and nothing is cached.
+	class hltypesExport DirWatch
+	{
+	public:
+		/// @brief Checks if directories can be watched on this platform.
+		/// @return True if directories can be watched.
+		static bool is_supported();
+		/// @brief Starts watching a directory.
+		/// @param[in] dirname Name of the directory.
+		/// @param[in] recursive Whether all subdirectories should be watched as well, including ones that are created later.
+		/// @return True if the directory is being watched.
+		static bool add(const String& dirname, bool recursive = false);
+		/// @brief Stops watching a directory.
+		/// @param[in] dirname Name of the directory.
+		/// @return True if the directory was being watched.
+		/// @note If the directory was added recursively, its subdirectories are not watched anymore either.
+		static bool remove(const String& dirname);
+		/// @brief Stops watching all directories.
+		static void clear();
+		/// @brief Checks if a directory is being watched.
+		/// @param[in] dirname Name of the directory.
+		/// @return True if the directory is being watched.
+		/// @note Processes all pending changes first.
+		static bool is_watched(const String& dirname);
+		/// @brief Processes all pending changes.
+		/// @note Never blocks. Callbacks are called from the thread that calls this, unless another thread is currently calling them. That
+		/// thread then calls them for these changes as well.
+		static void update();
+		/// @brief Registers a function that is called for every watched directory that changed.
+		/// @param[in] callback Function pointer with function that takes the name of the directory and the argument.
+		/// @param[in] argument Argument that is passed to the callback.
+		/// @note Callbacks can be called from any thread that uses cached Dir operations, but never from multiple threads at the same time.
+		/// @note Callbacks may call subscribe, unsubscribe and cached Dir operations themselves. Changes of the registered callbacks apply to
+		/// the next changed directories that are reported.
+		static void subscribe(void (*callback)(const String& dirname, void* argument), void* argument = NULL);
+		/// @brief Unregisters a function that was registered with subscribe.
+		/// @param[in] callback Function pointer that was registered.
+		/// @param[in] argument Argument that was registered.
+		static void unsubscribe(void (*callback)(const String& dirname, void* argument), void* argument = NULL);
+
+	protected:
+		/// @brief Basic constructor.
+		/// @note Forces this to be a static class.
+		DirWatch() { }
+		/// @brief Basic constructor.
+		/// @note Forces this to be a static class.
+		~DirWatch() { }
+
+	};
+}
+
+/// @brief Alias for simpler code.
+typedef hltypes::DirWatch hdirwatch;
+
+#endif
+
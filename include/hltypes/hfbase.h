@@ -64,7 +64,12 @@ namespace hltypes
 			/// @brief Read, write and create file mode. ("w+b")
 			READ_WRITE_CREATE,
 			/// @brief Read and append file mode. ("a+b")
-			READ_APPEND
+			READ_APPEND,
+			/// @brief Read-only memory-mapped file mode.
+			/// @note Reading and seeking work directly on the mapped memory without copying through stdio buffers.
+			/// @note Falls back to READ on platforms where memory mapping is not available.
+			/// @note The file must not be truncated by another process while it is mapped.
+			READ_MAPPED
 		};
 		
 		/// @brief Constructor with filename.
@@ -98,6 +103,15 @@ namespace hltypes
 		String filename;
 		/// @brief OS file handle.
 		void* cfile;
+		/// @brief Whether the file is opened as a memory mapping.
+		bool mapped;
+		/// @brief Memory mapped file data.
+		/// @note Is NULL for empty mapped files.
+		unsigned char* mapped_data;
+		/// @brief Size of the memory mapped file data.
+		long mapped_size;
+		/// @brief Current position within the memory mapped file data.
+		long mapped_position;
 
 		/// @brief Gets special descriptor.
 		/// @return Special descriptor.
@@ -109,6 +123,9 @@ namespace hltypes
 		/// @param[in] encryption_offset Byte value offset while reading/writing that serves as simple binary encryption.
 		/// @note If this instance is already working with an opened file handle, that file handle will be closed.
 		void _fopen(const String& filename, AccessMode access_mode, unsigned char encryption_offset, int repeats, float timeout);
+		/// @brief Maps an OS file into memory for reading.
+		/// @return True if the file was mapped successfully.
+		bool _fmap();
 		/// @brief Closes file.
 		void _fclose();
 		/// @brief Reads data from the file.
@@ -122,7 +139,10 @@ namespace hltypes
 		/// @param[in] size Size in bytes of a single buffer element.
 		/// @param[in] count Number of elements contained in buffer.
 		/// @return Number of bytes written.
+		/// @note Keeps the data size up to date without querying the file's end.
 		long _fwrite(const void* buffer, int size, int count);
+		/// @brief Queries the OS for the file size and updates the internal data size.
+		void _fupdate_data_size();
 		/// @brief Checks if file is open.
 		/// @return True if file is open.
 		bool _fis_open();
@@ -50,6 +50,13 @@ namespace hltypes
 		void open(const String& filename, AccessMode access_mode = READ, unsigned char encryption_offset = 0);
 		/// @brief Closes file.
 		void close();
+		/// @brief Gets direct access to the file data when opened with READ_MAPPED.
+		/// @return Pointer to the beginning of the mapped file data or NULL if the file is not mapped or empty.
+		/// @note The pointer is valid only until the file is closed.
+		const unsigned char* getMappedData() { return this->mapped_data; }
+		/// @brief Queries the OS for the current file size.
+		/// @note The size is tracked while writing so this is only needed if the file was modified externally while open.
+		void refresh_size();
 		
 		/// @brief Creates a file.
 		/// @param[in] filename Name of the file.
@@ -137,6 +144,13 @@ namespace hltypes
 		/// @param[in] offset Seeking offset in bytes.
 		/// @param[in] seek_mode Seeking mode.
 		void _seek(long offset, SeekMode seek_mode = CURRENT);
+		/// @brief Updates internal data size.
+		/// @note Does nothing since _fwrite() already keeps track of the size.
+		void _update_data_size();
+		/// @brief Gets direct access to the remaining mapped data.
+		/// @param[out] size Number of bytes available from the current position.
+		/// @return Pointer to the data at the current position or NULL if the file is not mapped.
+		const unsigned char* _direct_data(long& size);
 
 	};
 }
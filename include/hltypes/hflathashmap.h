@@ -0,0 +1,959 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+/// 
+/// @section DESCRIPTION
+/// 
+/// Provides an open-addressing hash map with high level methods.
+
+#ifndef HLTYPES_FLAT_HASH_MAP_H
+#define HLTYPES_FLAT_HASH_MAP_H
+
+#include <new>
+#include <utility>
+
+#include "harray.h"
+#include "hhashmap.h"
+#include "hstring.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HL_FLAT_HASH_MAP_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// @brief Number of control bytes that are checked at once when probing.
+#define HL_FLAT_HASH_MAP_GROUP_SIZE 16
+
+/// @brief Provides a simpler syntax to iterate through a FlatHashMap.
+#define foreach_flat_map(type_key, type_value, name, container) for (hltypes::FlatHashMap<type_key, type_value >::iterator name = (container).begin(); name != (container).end(); ++name)
+#define foreachc_flat_map(type_key, type_value, name, container) for (hltypes::FlatHashMap<type_key, type_value >::const_iterator name = (container).begin(); name != (container).end(); ++name)
+/// @brief Provides a simpler syntax to iterate through a FlatHashMap with String as key.
+#define foreach_fm(type, name, container) for (hltypes::FlatHashMap<hstr, type >::iterator name = (container).begin(); name != (container).end(); ++name)
+#define foreachc_fm(type, name, container) for (hltypes::FlatHashMap<hstr, type >::const_iterator name = (container).begin(); name != (container).end(); ++name)
+/// @brief Internal provider for simpler syntax to iterate through a FlatHashMap.
+#define __foreach_this_flat_map_it(name) for (const_iterator name = this->begin(); name != this->end(); ++name)
+
+namespace hltypes
+{
+	/// @brief Provides an open-addressing hash map with high level methods.
+	/// @note All entries are stored in one contiguous block. Control bytes with 7 bits of every key's hash are stored separately
+	/// and probed in groups so most lookups only compare keys that are very likely equal.
+	/// @note Inserting and removing entries invalidates iterators, pointers and references to entries.
+	/// @note Provides the same high level methods as Map, but entries are not sorted by key.
+	template <class K, class V, class H = Hash<K> > class FlatHashMap
+	{
+	public:
+		typedef std::pair<const K, V> value_type;
+		class iterator;
+		class const_iterator;
+		friend class iterator;
+		friend class const_iterator;
+
+		/// @brief Iterator through all entries.
+		class iterator
+		{
+		public:
+			friend class FlatHashMap<K, V, H>;
+			friend class const_iterator;
+			iterator() : map(NULL), index(0) { }
+			value_type& operator*() const { return this->map->slots[this->index]; }
+			value_type* operator->() const { return &this->map->slots[this->index]; }
+			iterator& operator++() { this->index = this->map->_next(this->index + 1); return (*this); }
+			iterator operator++(int) { iterator result(*this); ++(*this); return result; }
+			bool operator==(const iterator& other) const { return (this->index == other.index && this->map == other.map); }
+			bool operator!=(const iterator& other) const { return !(*this == other); }
+
+		protected:
+			FlatHashMap<K, V, H>* map;
+			int index;
+
+			iterator(FlatHashMap<K, V, H>* map, int index) : map(map), index(index) { }
+
+		};
+
+		/// @brief Constant iterator through all entries.
+		class const_iterator
+		{
+		public:
+			friend class FlatHashMap<K, V, H>;
+			const_iterator() : map(NULL), index(0) { }
+			const_iterator(const iterator& other) : map(other.map), index(other.index) { }
+			const value_type& operator*() const { return this->map->slots[this->index]; }
+			const value_type* operator->() const { return &this->map->slots[this->index]; }
+			const_iterator& operator++() { this->index = this->map->_next(this->index + 1); return (*this); }
+			const_iterator operator++(int) { const_iterator result(*this); ++(*this); return result; }
+			bool operator==(const const_iterator& other) const { return (this->index == other.index && this->map == other.map); }
+			bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+		protected:
+			const FlatHashMap<K, V, H>* map;
+			int index;
+
+			const_iterator(const FlatHashMap<K, V, H>* map, int index) : map(map), index(index) { }
+
+		};
+
+		/// @brief Empty constructor.
+		FlatHashMap() : ctrl(NULL), slots(NULL), capacity(0), count(0), deleted(0), growth_left(0)
+		{
+		}
+		/// @brief Copy constructor.
+		/// @param[in] other FlatHashMap to copy.
+		FlatHashMap(const FlatHashMap<K, V, H>& other) : ctrl(NULL), slots(NULL), capacity(0), count(0), deleted(0), growth_left(0)
+		{
+			this->insert(other);
+		}
+		/// @brief Destructor.
+		~FlatHashMap()
+		{
+			this->_destroy();
+		}
+		/// @brief Assignment operator.
+		/// @param[in] other FlatHashMap to copy.
+		/// @return This FlatHashMap.
+		FlatHashMap<K, V, H>& operator=(const FlatHashMap<K, V, H>& other)
+		{
+			if (this != &other)
+			{
+				FlatHashMap<K, V, H> copy(other);
+				this->swap(copy);
+			}
+			return (*this);
+		}
+		/// @brief Returns value with specified key.
+		/// @param[in] key Key of the value.
+		/// @return Value with specified key.
+		/// @note Adds a default constructed value if the key does not exist.
+		V& operator[](const K& key)
+		{
+			int index = this->_insert(key);
+			return this->slots[index].second;
+		}
+		/// @brief Same as key_of.
+		/// @see key_of
+		K operator()(const V& value) const
+		{
+			return this->key_of(value);
+		}
+		/// @brief Same as equals.
+		/// @see equals
+		bool operator==(const FlatHashMap<K, V, H>& other) const
+		{
+			return this->equals(other);
+		}
+		/// @brief Same as nequals.
+		/// @see nequals
+		bool operator!=(const FlatHashMap<K, V, H>& other) const
+		{
+			return this->nequals(other);
+		}
+		/// @brief Gets an iterator to the first entry.
+		/// @return Iterator to the first entry.
+		iterator begin()
+		{
+			return iterator(this, this->_next(0));
+		}
+		/// @brief Gets a constant iterator to the first entry.
+		/// @return Constant iterator to the first entry.
+		const_iterator begin() const
+		{
+			return const_iterator(this, this->_next(0));
+		}
+		/// @brief Gets an iterator past the last entry.
+		/// @return Iterator past the last entry.
+		iterator end()
+		{
+			return iterator(this, this->capacity);
+		}
+		/// @brief Gets a constant iterator past the last entry.
+		/// @return Constant iterator past the last entry.
+		const_iterator end() const
+		{
+			return const_iterator(this, this->capacity);
+		}
+		/// @brief Finds the entry with the given key.
+		/// @param[in] key Key of the entry.
+		/// @return Iterator to the entry or end() if the key does not exist.
+		iterator find(const K& key)
+		{
+			int index = this->_find(key);
+			return iterator(this, (index >= 0 ? index : this->capacity));
+		}
+		/// @brief Finds the entry with the given key.
+		/// @param[in] key Key of the entry.
+		/// @return Constant iterator to the entry or end() if the key does not exist.
+		const_iterator find(const K& key) const
+		{
+			int index = this->_find(key);
+			return const_iterator(this, (index >= 0 ? index : this->capacity));
+		}
+		/// @brief Removes the entry at the given position.
+		/// @param[in] position Iterator to the entry.
+		void erase(iterator position)
+		{
+			this->_erase(position.index);
+		}
+		/// @brief Removes the entry with the given key.
+		/// @param[in] key Key of the entry.
+		/// @return Number of removed entries.
+		int erase(const K& key)
+		{
+			int index = this->_find(key);
+			if (index < 0)
+			{
+				return 0;
+			}
+			this->_erase(index);
+			return 1;
+		}
+		/// @brief Removes all entries.
+		/// @note Keeps the allocated memory.
+		void clear()
+		{
+			this->_destroy_slots();
+			this->_reset_ctrl();
+		}
+		/// @brief Allocates enough memory for a number of entries.
+		/// @param[in] size Number of entries.
+		void reserve(int size)
+		{
+			int capacity = HL_FLAT_HASH_MAP_GROUP_SIZE;
+			while (capacity - capacity / 8 < size)
+			{
+				capacity *= 2;
+			}
+			if (capacity > this->capacity)
+			{
+				this->_rehash(capacity);
+			}
+		}
+		/// @brief Swaps the contents with another FlatHashMap.
+		/// @param[in] other Another FlatHashMap.
+		void swap(FlatHashMap<K, V, H>& other)
+		{
+			std::swap(this->ctrl, other.ctrl);
+			std::swap(this->slots, other.slots);
+			std::swap(this->capacity, other.capacity);
+			std::swap(this->count, other.count);
+			std::swap(this->deleted, other.deleted);
+			std::swap(this->growth_left, other.growth_left);
+		}
+		/// @brief Checks if the FlatHashMap is empty.
+		/// @return True if the FlatHashMap is empty.
+		bool empty() const
+		{
+			return (this->count == 0);
+		}
+		/// @brief Returns the number of values in the FlatHashMap.
+		/// @return The number of values in the FlatHashMap.
+		int size() const
+		{
+			return this->count;
+		}
+		/// @brief Returns an Array with all keys.
+		/// @return An Array with all keys.
+		/// @note The order of the keys is not defined.
+		Array<K> keys() const
+		{
+			Array<K> result;
+			result.reserve(this->count);
+			__foreach_this_flat_map_it(it)
+			{
+				result += it->first;
+			}
+			return result;
+		}
+		/// @brief Returns an Array with all values.
+		/// @return An Array with all values.
+		/// @note The order of the values is not defined.
+		Array<V> values() const
+		{
+			Array<V> result;
+			result.reserve(this->count);
+			__foreach_this_flat_map_it(it)
+			{
+				result += it->second;
+			}
+			return result;
+		}
+		/// @brief Returns an Array with all values in the same order as the given corresponding keys.
+		/// @return An Array with all values in the same order as the given corresponding keys.
+		Array<V> values(const Array<K>& keys)
+		{
+			Array<V> result;
+			for_iter (i, 0, keys.size())
+			{
+				result += (*this)[keys.at(i)];
+			}
+			return result;
+		}
+		/// @brief Compares the contents of two FlatHashMaps for being equal.
+		/// @param[in] other Another FlatHashMap.
+		/// @return True if number of keys and values are equal and all pairs of keys and values are equal.
+		bool equals(const FlatHashMap<K, V, H>& other) const
+		{
+			if (this->count != other.count)
+			{
+				return false;
+			}
+			int index = 0;
+			__foreach_this_flat_map_it(it)
+			{
+				index = other._find(it->first);
+				// making sure operator== is used, not !=
+				if (index < 0 || !(it->second == other.slots[index].second))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Compares the contents of two FlatHashMaps for being not equal.
+		/// @param[in] other Another FlatHashMap.
+		/// @return True if number of keys and values are not equal or at least one pair of keys and values is not equal.
+		bool nequals(const FlatHashMap<K, V, H>& other) const
+		{
+			if (this->count != other.count)
+			{
+				return true;
+			}
+			int index = 0;
+			__foreach_this_flat_map_it(it)
+			{
+				index = other._find(it->first);
+				// making sure operator!= is used, not ==
+				if (index < 0 || it->second != other.slots[index].second)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		/// @brief Returns key of specified value.
+		/// @param[in] value Value with the given key.
+		/// @return Key of specified value or a default constructed key if the value was not found.
+		K key_of(const V& value) const
+		{
+			__foreach_this_flat_map_it(it)
+			{
+				if (it->second == value)
+				{
+					return it->first;
+				}
+			}
+			return K();
+		}
+		/// @brief Returns value of specified key.
+		/// @param[in] key Key of the given value.
+		/// @return Value of specified key.
+		/// @note The key has to exist.
+		V value_of(const K& key) const
+		{
+			return this->slots[this->_find(key)].second;
+		}
+		/// @brief Checks for existence of a key.
+		/// @param[in] key Key to check.
+		/// @return True if key is present.
+		bool has_key(const K& key) const
+		{
+			return (this->_find(key) >= 0);
+		}
+		/// @brief Checks for existence of all keys.
+		/// @param[in] keys Array of keys to check.
+		/// @return True if all keys are present.
+		bool has_keys(const Array<K>& keys) const
+		{
+			for_iter (i, 0, keys.size())
+			{
+				if (this->_find(keys.at(i)) < 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Checks for existence of all keys.
+		/// @param[in] keys C-type array of keys to check.
+		/// @param[in] count Number of keys to check.
+		/// @return True if all keys are present.
+		bool has_keys(const K keys[], const int count) const
+		{
+			for_iter (i, 0, count)
+			{
+				if (this->_find(keys[i]) < 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Checks for existence of a value.
+		/// @param[in] value Value to check.
+		/// @return True if value is present.
+		bool has_value(const V& value) const
+		{
+			__foreach_this_flat_map_it(it)
+			{
+				if (it->second == value)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		/// @brief Checks for existence of all values.
+		/// @param[in] values Array of values to check.
+		/// @return True if all values are present.
+		bool has_values(const Array<V>& values) const
+		{
+			for_iter (i, 0, values.size())
+			{
+				if (!this->has_value(values.at(i)))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Checks for existence of all values.
+		/// @param[in] values C-type array of values to check.
+		/// @param[in] count Number of values to check.
+		/// @return True if all values are present.
+		bool has_values(const V values[], const int count) const
+		{
+			for_iter (i, 0, count)
+			{
+				if (!this->has_value(values[i]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Adds a new pair of key and value into the FlatHashMap.
+		/// @param[in] key Key of the entry.
+		/// @param[in] value Value of the entry.
+		void insert(const K& key, const V& value)
+		{
+			(*this)[key] = value;
+		}
+		/// @brief Adds all pairs of keys and values from another FlatHashMap into this one.
+		/// @param[in] other Another FlatHashMap.
+		/// @note Entries with already existing keys will not be overwritten.
+		void insert(const FlatHashMap<K, V, H>& other)
+		{
+			this->reserve(this->count + other.count);
+			int size = 0;
+			for (const_iterator it = other.begin(); it != other.end(); ++it)
+			{
+				size = this->count;
+				int index = this->_insert(it->first);
+				if (this->count > size)
+				{
+					this->slots[index].second = it->second;
+				}
+			}
+		}
+		/// @brief Adds all pairs of keys and values from another FlatHashMap into this one.
+		/// @param[in] other Another FlatHashMap.
+		/// @note Entries with already existing keys will be overwritten.
+		void inject(const FlatHashMap<K, V, H>& other)
+		{
+			this->reserve(this->count + other.count);
+			for (const_iterator it = other.begin(); it != other.end(); ++it)
+			{
+				(*this)[it->first] = it->second;
+			}
+		}
+		/// @brief Removes a pair of key and value specified by a key.
+		/// @param[in] key Key of the entry.
+		void remove_key(const K& key)
+		{
+			this->erase(key);
+		}
+		/// @brief Removes all pairs of key and value specified by an Array of keys.
+		/// @param[in] keys Array of keys.
+		void remove_keys(const Array<K>& keys)
+		{
+			for_iter (i, 0, keys.size())
+			{
+				this->erase(keys.at(i));
+			}
+		}
+		/// @brief Removes a pair of key and value specified by a value.
+		/// @param[in] value Value of the entry.
+		void remove_value(const V& value)
+		{
+			for (iterator it = this->begin(); it != this->end(); ++it)
+			{
+				if (it->second == value)
+				{
+					this->_erase(it.index);
+					break;
+				}
+			}
+		}
+		/// @brief Removes all pairs of key and value specified by an Array of values.
+		/// @param[in] values Array of values.
+		void remove_values(const Array<V>& values)
+		{
+			for_iter (i, 0, values.size())
+			{
+				this->remove_value(values.at(i));
+			}
+		}
+		/// @brief Gets a random element in FlatHashMap.
+		/// @param[out] value Value of selected random entry.
+		/// @return Random element.
+		K random(V* value = NULL) const
+		{
+			if (this->count == 0)
+			{
+				throw container_empty_error("random()");
+			}
+			K key = this->keys()[hrand(this->count)];
+			if (value != NULL)
+			{
+				*value = this->value_of(key);
+			}
+			return key;
+		}
+		/// @brief Gets a FlatHashMap of random elements selected from this one.
+		/// @param[in] count Number of random elements.
+		/// @return FlatHashMap of random elements selected from this one.
+		FlatHashMap<K, V, H> random(int count) const
+		{
+			if (count >= this->count)
+			{
+				return FlatHashMap<K, V, H>(*this);
+			}
+			FlatHashMap<K, V, H> result;
+			if (count > 0)
+			{
+				Array<K> keys = this->keys();
+				K key;
+				for_iter (i, 0, count)
+				{
+					key = keys.remove_at(hrand(keys.size()));
+					result[key] = this->value_of(key);
+				}
+			}
+			return result;
+		}
+		/// @brief Gets a random element in FlatHashMap and removes it.
+		/// @param[out] value Value of selected random entry.
+		/// @return Random element.
+		K pop_random(V* value = NULL)
+		{
+			if (this->count == 0)
+			{
+				throw container_empty_error("pop_random()");
+			}
+			K key = this->random(value);
+			this->erase(key);
+			return key;
+		}
+		/// @brief Gets a FlatHashMap of random elements selected from this one and removes them.
+		/// @param[in] count Number of random elements.
+		/// @return FlatHashMap of random elements selected from this one.
+		FlatHashMap<K, V, H> pop_random(int count)
+		{
+			FlatHashMap<K, V, H> result = this->random(count);
+			for (const_iterator it = result.begin(); it != result.end(); ++it)
+			{
+				this->erase(it->first);
+			}
+			return result;
+		}
+		/// @brief Same as pop_random.
+		/// @see pop_random().
+		K remove_random(V* value = NULL)
+		{
+			return this->pop_random(value);
+		}
+		/// @brief Same as pop_random.
+		/// @see pop_random(const int count).
+		FlatHashMap<K, V, H> remove_random(const int count)
+		{
+			return this->pop_random(count);
+		}
+		/// @brief Finds and returns new FlatHashMap with entries that match the condition.
+		/// @param[in] condition_function Function pointer with condition function that takes a key of type K and a value of type V and returns bool.
+		/// @return New FlatHashMap with all matching elements.
+		FlatHashMap<K, V, H> find_all(bool (*condition_function)(K, V)) const
+		{
+			FlatHashMap<K, V, H> result;
+			__foreach_this_flat_map_it(it)
+			{
+				if (condition_function(it->first, it->second))
+				{
+					result[it->first] = it->second;
+				}
+			}
+			return result;
+		}
+		/// @brief Checks if at least one entry matches the condition.
+		/// @param[in] condition_function Function pointer with condition function that takes a key of type K and a value of type V and returns bool.
+		/// @return True if at least one entry matches the condition.
+		bool matches_any(bool (*condition_function)(K, V)) const
+		{
+			__foreach_this_flat_map_it(it)
+			{
+				if (condition_function(it->first, it->second))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		/// @brief Checks if all entries match the condition.
+		/// @param[in] condition_function Function pointer with condition function that takes a key of type K and a value of type V and returns bool.
+		/// @return True if all entries match the condition.
+		bool matches_all(bool (*condition_function)(K, V)) const
+		{
+			__foreach_this_flat_map_it(it)
+			{
+				if (!condition_function(it->first, it->second))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Returns a new FlatHashMap with all keys and values cast into the type L and S.
+		/// @return A new FlatHashMap with all keys and values cast into the type L and S.
+		/// @note Make sure all keys can be cast into type L and all values into type S.
+		template <class L, class S>
+		FlatHashMap<L, S> cast() const
+		{
+			FlatHashMap<L, S> result;
+			result.reserve(this->count);
+			__foreach_this_flat_map_it(it)
+			{
+				result[(L)it->first] = (S)it->second;
+			}
+			return result;
+		}
+		/// @brief Finds and returns value stored at key. In case no value is found, returns the given default value.
+		/// @param[in] key Key to retrieve the value of.
+		/// @param[in] defaultValue Default value to return if key does not exist.
+		/// @return Value stored at key or given default value.
+		V try_get_by_key(const K& key, V defaultValue) const
+		{
+			int index = this->_find(key);
+			return (index >= 0 ? this->slots[index].second : defaultValue);
+		}
+		/// @brief Same as insert.
+		/// @see insert(const FlatHashMap<K, V, H>& other)
+		FlatHashMap<K, V, H>& operator+=(const FlatHashMap<K, V, H>& other)
+		{
+			this->insert(other);
+			return (*this);
+		}
+		/// @brief Merges two FlatHashMaps.
+		/// @param[in] other Second FlatHashMap to merge with.
+		/// @return New FlatHashMap with elements of both FlatHashMaps.
+		/// @note Entries with already existing keys in the first FlatHashMap will not be overwritten.
+		FlatHashMap<K, V, H> operator+(const FlatHashMap<K, V, H>& other) const
+		{
+			FlatHashMap<K, V, H> result(*this);
+			result += other;
+			return result;
+		}
+
+	protected:
+		/// @brief Control byte of a slot that was never used.
+		static const signed char EMPTY = -128;
+		/// @brief Control byte of a slot whose entry was removed.
+		static const signed char DELETED = -2;
+
+		/// @brief Control bytes, one for every slot and a copy of the first group at the end so groups can be loaded without wrapping.
+		/// @note Full slots contain the lowest 7 bits of the hash.
+		signed char* ctrl;
+		/// @brief Storage for entries.
+		value_type* slots;
+		/// @brief Number of slots, always 0 or a power of 2.
+		int capacity;
+		/// @brief Number of entries.
+		int count;
+		/// @brief Number of slots whose entries were removed.
+		int deleted;
+		/// @brief Number of entries that can be added before the table has to be rehashed.
+		int growth_left;
+
+		/// @brief Calculates the hash of a key.
+		/// @param[in] key The key.
+		/// @return The hash.
+		/// @note The hash is mixed additionally so that weak hashes like pointers are spread over all bits.
+		static unsigned long long _hash(const K& key)
+		{
+			unsigned long long result = (unsigned long long)H()(key) * 0x9E3779B97F4A7C15ULL;
+			return (result ^ (result >> 29));
+		}
+		/// @brief Gets the index of the lowest set bit.
+		/// @param[in] bits Bit mask that is not 0.
+		/// @return Index of the lowest set bit.
+		static int _lowest_bit(unsigned int bits)
+		{
+#if defined(__GNUC__)
+			return __builtin_ctz(bits);
+#elif defined(_MSC_VER)
+			unsigned long result = 0;
+			_BitScanForward(&result, bits);
+			return (int)result;
+#else
+			int result = 0;
+			while ((bits & 1) == 0)
+			{
+				bits >>= 1;
+				++result;
+			}
+			return result;
+#endif
+		}
+		/// @brief Gets a bit mask of the control bytes in a group that are equal to a value.
+		/// @param[in] position Index of the first control byte of the group.
+		/// @param[in] value The value.
+		/// @return Bit mask with one bit for every control byte.
+		unsigned int _match(int position, signed char value) const
+		{
+#ifdef HL_FLAT_HASH_MAP_SSE2
+			__m128i group = _mm_loadu_si128((const __m128i*)&this->ctrl[position]);
+			return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(value), group));
+#else
+			unsigned int result = 0;
+			for_iter (i, 0, HL_FLAT_HASH_MAP_GROUP_SIZE)
+			{
+				if (this->ctrl[position + i] == value)
+				{
+					result |= (1 << i);
+				}
+			}
+			return result;
+#endif
+		}
+		/// @brief Gets a bit mask of the control bytes in a group that belong to empty or deleted slots.
+		/// @param[in] position Index of the first control byte of the group.
+		/// @return Bit mask with one bit for every control byte.
+		unsigned int _match_free(int position) const
+		{
+#ifdef HL_FLAT_HASH_MAP_SSE2
+			__m128i group = _mm_loadu_si128((const __m128i*)&this->ctrl[position]);
+			return (unsigned int)_mm_movemask_epi8(_mm_cmplt_epi8(group, _mm_set1_epi8(-1)));
+#else
+			unsigned int result = 0;
+			for_iter (i, 0, HL_FLAT_HASH_MAP_GROUP_SIZE)
+			{
+				if (this->ctrl[position + i] < -1)
+				{
+					result |= (1 << i);
+				}
+			}
+			return result;
+#endif
+		}
+		/// @brief Sets a control byte and its copy.
+		/// @param[in] index Index of the slot.
+		/// @param[in] value New value.
+		void _set_ctrl(int index, signed char value)
+		{
+			this->ctrl[index] = value;
+			if (index < HL_FLAT_HASH_MAP_GROUP_SIZE - 1)
+			{
+				this->ctrl[this->capacity + index] = value;
+			}
+		}
+		/// @brief Finds the slot of a key.
+		/// @param[in] key The key.
+		/// @return Index of the slot or -1 if the key does not exist.
+		int _find(const K& key) const
+		{
+			if (this->capacity == 0)
+			{
+				return -1;
+			}
+			unsigned long long hash = _hash(key);
+			signed char value = (signed char)(hash & 0x7F);
+			int mask = this->capacity - 1;
+			int position = (int)((hash >> 7) & mask);
+			int index = 0;
+			unsigned int bits = 0;
+			// groups are probed with increasing steps which visits every group once
+			for (int step = HL_FLAT_HASH_MAP_GROUP_SIZE; true; step += HL_FLAT_HASH_MAP_GROUP_SIZE)
+			{
+				bits = this->_match(position, value);
+				while (bits != 0)
+				{
+					index = (position + _lowest_bit(bits)) & mask;
+					if (this->slots[index].first == key)
+					{
+						return index;
+					}
+					bits &= bits - 1;
+				}
+				// an empty slot ends the probing since the key would have been inserted there
+				if (this->_match(position, EMPTY) != 0)
+				{
+					return -1;
+				}
+				position = (position + step) & mask;
+			}
+			return -1;
+		}
+		/// @brief Finds a free slot for a hash.
+		/// @param[in] hash The hash.
+		/// @return Index of the slot.
+		int _find_free(unsigned long long hash) const
+		{
+			int mask = this->capacity - 1;
+			int position = (int)((hash >> 7) & mask);
+			unsigned int bits = 0;
+			for (int step = HL_FLAT_HASH_MAP_GROUP_SIZE; true; step += HL_FLAT_HASH_MAP_GROUP_SIZE)
+			{
+				bits = this->_match_free(position);
+				if (bits != 0)
+				{
+					return ((position + _lowest_bit(bits)) & mask);
+				}
+				position = (position + step) & mask;
+			}
+			return -1;
+		}
+		/// @brief Finds the slot of a key and adds a new entry if the key does not exist.
+		/// @param[in] key The key.
+		/// @return Index of the slot.
+		int _insert(const K& key)
+		{
+			int index = this->_find(key);
+			if (index >= 0)
+			{
+				return index;
+			}
+			if (this->growth_left == 0)
+			{
+				// removed entries are cleared up if they take up a lot of space, otherwise the table grows
+				int maximum = this->capacity - this->capacity / 8;
+				this->_rehash(this->capacity == 0 ? HL_FLAT_HASH_MAP_GROUP_SIZE : (this->count * 2 <= maximum ? this->capacity : this->capacity * 2));
+			}
+			unsigned long long hash = _hash(key);
+			index = this->_find_free(hash);
+			if (this->ctrl[index] == DELETED)
+			{
+				--this->deleted;
+			}
+			else
+			{
+				--this->growth_left;
+			}
+			new (&this->slots[index]) value_type(key, V());
+			this->_set_ctrl(index, (signed char)(hash & 0x7F));
+			++this->count;
+			return index;
+		}
+		/// @brief Removes the entry in a slot.
+		/// @param[in] index Index of the slot.
+		void _erase(int index)
+		{
+			this->slots[index].~value_type();
+			this->_set_ctrl(index, DELETED);
+			--this->count;
+			++this->deleted;
+		}
+		/// @brief Gets the next full slot.
+		/// @param[in] index Index of the slot where the search starts.
+		/// @return Index of the next full slot or the capacity if there are no more full slots.
+		int _next(int index) const
+		{
+			while (index < this->capacity && this->ctrl[index] < 0)
+			{
+				++index;
+			}
+			return index;
+		}
+		/// @brief Marks all slots as empty.
+		void _reset_ctrl()
+		{
+			for_iter (i, 0, this->capacity + HL_FLAT_HASH_MAP_GROUP_SIZE - 1)
+			{
+				this->ctrl[i] = EMPTY;
+			}
+			this->count = 0;
+			this->deleted = 0;
+			this->growth_left = this->capacity - this->capacity / 8;
+		}
+		/// @brief Destroys all entries.
+		void _destroy_slots()
+		{
+			for_iter (i, 0, this->capacity)
+			{
+				if (this->ctrl[i] >= 0)
+				{
+					this->slots[i].~value_type();
+				}
+			}
+		}
+		/// @brief Destroys all entries and frees the memory.
+		void _destroy()
+		{
+			if (this->capacity > 0)
+			{
+				this->_destroy_slots();
+				delete [] this->ctrl;
+				::operator delete(this->slots);
+			}
+			this->ctrl = NULL;
+			this->slots = NULL;
+			this->capacity = 0;
+			this->count = 0;
+			this->deleted = 0;
+			this->growth_left = 0;
+		}
+		/// @brief Moves all entries into a new table.
+		/// @param[in] capacity Number of slots of the new table.
+		void _rehash(int capacity)
+		{
+			signed char* oldCtrl = this->ctrl;
+			value_type* oldSlots = this->slots;
+			int oldCapacity = this->capacity;
+			this->ctrl = new signed char[capacity + HL_FLAT_HASH_MAP_GROUP_SIZE - 1];
+			this->slots = (value_type*)::operator new(sizeof(value_type) * capacity);
+			this->capacity = capacity;
+			this->_reset_ctrl();
+			unsigned long long hash = 0;
+			int index = 0;
+			for_iter (i, 0, oldCapacity)
+			{
+				if (oldCtrl[i] >= 0)
+				{
+					hash = _hash(oldSlots[i].first);
+					index = this->_find_free(hash);
+					new (&this->slots[index]) value_type(oldSlots[i]);
+					this->_set_ctrl(index, (signed char)(hash & 0x7F));
+					oldSlots[i].~value_type();
+					++this->count;
+					--this->growth_left;
+				}
+			}
+			if (oldCapacity > 0)
+			{
+				delete [] oldCtrl;
+				::operator delete(oldSlots);
+			}
+		}
+
+	};
+
+}
+
+/// @brief Alias for simpler code.
+#define hflathashmap hltypes::FlatHashMap
+
+#endif
@@ -0,0 +1,540 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+/// 
+/// @section DESCRIPTION
+/// 
+/// Encapsulates std::unordered_map and adds high level methods.
+
+#ifndef HLTYPES_HASH_MAP_H
+#define HLTYPES_HASH_MAP_H
+
+#include "harray.h"
+#include "hstring.h"
+
+#if __cplusplus >= 201103L || defined(_LIBCPP_VERSION) || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#include <functional>
+#include <unordered_map>
+#define stdhashmap_t std::unordered_map
+#define stdhash_t std::hash
+#else
+#include <tr1/functional>
+#include <tr1/unordered_map>
+#define stdhashmap_t std::tr1::unordered_map
+#define stdhash_t std::tr1::hash
+#endif
+
+/// @brief Provides a simpler syntax to iterate through a HashMap.
+#define foreach_hmap(type_key, type_value, name, container) for (hltypes::HashMap<type_key, type_value >::iterator name = (container).begin(); name != (container).end(); ++name)
+#define foreachc_hmap(type_key, type_value, name, container) for (hltypes::HashMap<type_key, type_value >::const_iterator name = (container).begin(); name != (container).end(); ++name)
+/// @brief Provides a simpler syntax to iterate through a HashMap with String as key.
+#define foreach_hm(type, name, container) for (hltypes::HashMap<hstr, type >::iterator name = (container).begin(); name != (container).end(); ++name)
+#define foreachc_hm(type, name, container) for (hltypes::HashMap<hstr, type >::const_iterator name = (container).begin(); name != (container).end(); ++name)
+/// @brief Internal provider for simpler syntax to iterate through a HashMap.
+#define __foreach_this_hash_map_it(name) for (iterator_map_t name = stdhashmap::begin(); name != stdhashmap::end(); ++name)
+/// @brief Internal provider for simpler syntax to iterate through a HashMap.
+#define __foreach_other_hash_map_it(name, other) for (iterator_map_t name = other.begin(); name != other.end(); ++name)
+/// @brief Alias for simpler code.
+#define stdhashmap stdhashmap_t<K, V, Hash<K> >
+
+namespace hltypes
+{
+	/// @brief Hash function object used by HashMap.
+	/// @note Uses the standard hash by default.
+	template <class K> struct Hash : public stdhash_t<K>
+	{
+	};
+
+	/// @brief Hash function object for String.
+	/// @note Uses String::hash.
+	template <> struct Hash<String>
+	{
+		size_t operator()(const String& key) const
+		{
+			return (size_t)key.hash();
+		}
+
+	};
+
+	/// @brief Encapsulates std::unordered_map and adds high level methods.
+	/// @note Provides the same high level methods as Map, but entries are not sorted by key.
+	template <class K, class V> class HashMap : public stdhashmap
+	{
+	private:
+		typedef typename stdhashmap::const_iterator iterator_map_t;
+		typedef typename std::vector<K>::const_iterator iterator_map_key_t;
+	public:
+		/// @brief Empty constructor.
+		HashMap() : stdhashmap()
+		{
+		}
+		/// @brief Copy constructor.
+		/// @param[in] other HashMap to copy.
+		HashMap(const HashMap<K, V>& other) : stdhashmap(other)
+		{
+		}
+		/// @brief Destructor.
+		~HashMap()
+		{
+		}
+		/// @brief Returns value with specified key.
+		/// @param[in] key Key of the value.
+		/// @return Value with specified key.
+		V& operator[](const K& key)
+		{
+			return stdhashmap::operator[](key);
+		}
+		/// @brief Same as key_of.
+		/// @see key_of
+		K operator()(const V& value) const
+		{
+			return this->key_of(value);
+		}
+		/// @brief Same as equals.
+		/// @see equals
+		bool operator==(const HashMap<K, V>& other) const
+		{
+			return this->equals(other);
+		}
+		/// @brief Same as nequals.
+		/// @see nequals
+		bool operator!=(const HashMap<K, V>& other) const
+		{
+			return this->nequals(other);
+		}
+		/// @brief Returns the number of values in the HashMap.
+		/// @return The number of values in the HashMap.
+		int size() const
+		{
+			return (int)stdhashmap::size();
+		}
+		/// @brief Returns an Array with all keys.
+		/// @return An Array with all keys.
+		/// @note The order of the keys is not defined.
+		Array<K> keys() const
+		{
+			Array<K> result;
+			result.reserve(stdhashmap::size());
+			__foreach_this_hash_map_it(it)
+			{
+				result += it->first;
+			}
+			return result;
+		}
+		/// @brief Returns an Array with all values.
+		/// @return An Array with all values.
+		/// @note The order of the values is not defined.
+		Array<V> values() const
+		{
+			Array<V> result;
+			result.reserve(stdhashmap::size());
+			__foreach_this_hash_map_it(it)
+			{
+				result += it->second;
+			}
+			return result;
+		}
+		/// @brief Returns an Array with all values in the same order as the given corresponding keys.
+		/// @return An Array with all values in the same order as the given corresponding keys.
+		Array<V> values(Array<K> keys)
+		{
+			Array<V> result;
+			for (iterator_map_key_t it = keys.begin(); it != keys.end(); ++it) // don't change, requires a const iterator
+			{
+				result += stdhashmap::operator[](*it);
+			}
+			return result;
+		}
+		/// @brief Compares the contents of two HashMaps for being equal.
+		/// @param[in] other Another HashMap.
+		/// @return True if number of keys and values are equal and all pairs of keys and values are equal.
+		bool equals(const HashMap<K, V>& other) const
+		{
+			if (this->size() != other.size())
+			{
+				return false;
+			}
+			iterator_map_t found;
+			__foreach_this_hash_map_it(it)
+			{
+				found = other.find(it->first);
+				// making sure operator== is used, not !=
+				if (found == other.end() || !(it->second == found->second))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Compares the contents of two HashMaps for being not equal.
+		/// @param[in] other Another HashMap.
+		/// @return True if number of keys and values are not equal or at least one pair of keys and values is not equal.
+		bool nequals(const HashMap<K, V>& other) const
+		{
+			if (this->size() != other.size())
+			{
+				return true;
+			}
+			iterator_map_t found;
+			__foreach_this_hash_map_it(it)
+			{
+				found = other.find(it->first);
+				// making sure operator!= is used, not ==
+				if (found == other.end() || it->second != found->second)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		/// @brief Returns key of specified value.
+		/// @param[in] value Value with the given key.
+		/// @return Key of specified value or a default constructed key if the value was not found.
+		K key_of(const V& value) const
+		{
+			__foreach_this_hash_map_it(it)
+			{
+				if (it->second == value)
+				{
+					return it->first;
+				}
+			}
+			return K();
+		}
+		/// @brief Returns value of specified key.
+		/// @param[in] key Key of the given value.
+		/// @return Value of specified key.
+		V value_of(const K& key) const
+		{
+			return stdhashmap::find(key)->second;
+		}
+		/// @brief Checks for existence of a key.
+		/// @param[in] key Key to check.
+		/// @return True if key is present.
+		bool has_key(const K& key) const
+		{
+			return (stdhashmap::find(key) != stdhashmap::end());
+		}
+		/// @brief Checks for existence of all keys.
+		/// @param[in] keys Array of keys to check.
+		/// @return True if all keys are present.
+		bool has_keys(const Array<K>& keys) const
+		{
+			iterator_map_t end = stdhashmap::end();
+			for_iter (i, 0, keys.size())
+			{
+				if (stdhashmap::find(keys.at(i)) == end)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Checks for existence of all keys.
+		/// @param[in] keys C-type array of keys to check.
+		/// @param[in] count Number of keys to check.
+		/// @return True if all keys are present.
+		bool has_keys(const K keys[], const int count) const
+		{
+			iterator_map_t end = stdhashmap::end();
+			for_iter (i, 0, count)
+			{
+				if (stdhashmap::find(keys[i]) == end)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Checks for existence of a value.
+		/// @param[in] value Value to check.
+		/// @return True if value is present.
+		bool has_value(const V& value) const
+		{
+			__foreach_this_hash_map_it(it)
+			{
+				if (it->second == value)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		/// @brief Checks for existence of all values.
+		/// @param[in] values Array of values to check.
+		/// @return True if all values are present.
+		bool has_values(const Array<V>& values) const
+		{
+			for_iter (i, 0, values.size())
+			{
+				if (!this->has_value(values.at(i)))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Checks for existence of all values.
+		/// @param[in] values C-type array of values to check.
+		/// @param[in] count Number of values to check.
+		/// @return True if all values are present.
+		bool has_values(const V values[], const int count) const
+		{
+			for_iter (i, 0, count)
+			{
+				if (!this->has_value(values[i]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Adds a new pair of key and value into the HashMap.
+		/// @param[in] key Key of the entry.
+		/// @param[in] value Value of the entry.
+		void insert(const K& key, const V& value)
+		{
+			stdhashmap::operator[](key) = value;
+		}
+		/// @brief Adds all pairs of keys and values from another HashMap into this one.
+		/// @param[in] other Another HashMap.
+		/// @note Entries with already existing keys will not be overwritten.
+		void insert(const HashMap<K, V>& other)
+		{
+			stdhashmap::insert(other.begin(), other.end());
+		}
+		/// @brief Adds all pairs of keys and values from another HashMap into this one.
+		/// @param[in] other Another HashMap.
+		/// @note Entries with already existing keys will be overwritten.
+		void inject(const HashMap<K, V>& other)
+		{
+			__foreach_other_hash_map_it(it, other)
+			{
+				stdhashmap::operator[](it->first) = it->second;
+			}
+		}
+		/// @brief Removes a pair of key and value specified by a key.
+		/// @param[in] key Key of the entry.
+		void remove_key(const K& key)
+		{
+			stdhashmap::erase(key);
+		}
+		/// @brief Removes all pairs of key and value specified by an Array of keys.
+		/// @param[in] keys Array of keys.
+		void remove_keys(const Array<K>& keys)
+		{
+			for_iter (i, 0, keys.size())
+			{
+				stdhashmap::erase(keys.at(i));
+			}
+		}
+		/// @brief Removes a pair of key and value specified by a value.
+		/// @param[in] value Value of the entry.
+		void remove_value(const V& value)
+		{
+			__foreach_this_hash_map_it(it)
+			{
+				if (it->second == value)
+				{
+					stdhashmap::erase(it->first);
+					break;
+				}
+			}
+		}
+		/// @brief Removes all pairs of key and value specified by an Array of values.
+		/// @param[in] values Array of values.
+		void remove_values(const Array<V>& values)
+		{
+			for_iter (i, 0, values.size())
+			{
+				this->remove_value(values.at(i));
+			}
+		}
+		/// @brief Gets a random element in HashMap.
+		/// @param[out] value Value of selected random entry.
+		/// @return Random element.
+		K random(V* value = NULL) const
+		{
+			if (this->size() == 0)
+			{
+				throw container_empty_error("random()");
+			}
+			K key = this->keys()[hrand(this->size())];
+			if (value != NULL)
+			{
+				*value = stdhashmap::find(key)->second;
+			}
+			return key;
+		}
+		/// @brief Gets a HashMap of random elements selected from this one.
+		/// @param[in] count Number of random elements.
+		/// @return HashMap of random elements selected from this one.
+		HashMap<K, V> random(int count) const
+		{
+			if (count >= this->size())
+			{
+				return HashMap<K, V>(*this);
+			}
+			HashMap<K, V> result;
+			if (count > 0)
+			{
+				Array<K> keys = this->keys();
+				K key;
+				for_iter (i, 0, count)
+				{
+					key = keys.remove_at(hrand(keys.size()));
+					result[key] = stdhashmap::find(key)->second;
+				}
+			}
+			return result;
+		}
+		/// @brief Gets a random element in HashMap and removes it.
+		/// @param[out] value Value of selected random entry.
+		/// @return Random element.
+		K pop_random(V* value = NULL)
+		{
+			if (this->size() == 0)
+			{
+				throw container_empty_error("pop_random()");
+			}
+			K key = this->keys()[hrand(this->size())];
+			if (value != NULL)
+			{
+				*value = stdhashmap::find(key)->second;
+			}
+			stdhashmap::erase(key);
+			return key;
+		}
+		/// @brief Gets a HashMap of random elements selected from this one and removes them.
+		/// @param[in] count Number of random elements.
+		/// @return HashMap of random elements selected from this one.
+		HashMap<K, V> pop_random(int count)
+		{
+			if (count >= this->size())
+			{
+				HashMap<K, V> result(*this);
+				stdhashmap::clear();
+				return result;
+			}
+			HashMap<K, V> result;
+			if (count > 0)
+			{
+				Array<K> keys = this->keys();
+				K key;
+				for_iter (i, 0, count)
+				{
+					key = keys.remove_at(hrand(keys.size()));
+					result[key] = stdhashmap::find(key)->second;
+					stdhashmap::erase(key);
+				}
+			}
+			return result;
+		}
+		/// @brief Same as pop_random.
+		/// @see pop_random().
+		K remove_random(V* value = NULL)
+		{
+			return this->pop_random(value);
+		}
+		/// @brief Same as pop_random.
+		/// @see pop_random(const int count).
+		HashMap<K, V> remove_random(const int count)
+		{
+			return this->pop_random(count);
+		}
+		/// @brief Finds and returns new HashMap with entries that match the condition.
+		/// @param[in] condition_function Function pointer with condition function that takes a key of type K and a value of type V and returns bool.
+		/// @return New HashMap with all matching elements.
+		HashMap<K, V> find_all(bool (*condition_function)(K, V)) const
+		{
+			HashMap<K, V> result;
+			__foreach_this_hash_map_it(it)
+			{
+				if (condition_function(it->first, it->second))
+				{
+					result[it->first] = it->second;
+				}
+			}
+			return result;
+		}
+		/// @brief Checks if at least one entry matches the condition.
+		/// @param[in] condition_function Function pointer with condition function that takes a key of type K and a value of type V and returns bool.
+		/// @return True if at least one entry matches the condition.
+		bool matches_any(bool (*condition_function)(K, V)) const
+		{
+			__foreach_this_hash_map_it(it)
+			{
+				if (condition_function(it->first, it->second))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		/// @brief Checks if all entries match the condition.
+		/// @param[in] condition_function Function pointer with condition function that takes a key of type K and a value of type V and returns bool.
+		/// @return True if all entries match the condition.
+		bool matches_all(bool (*condition_function)(K, V)) const
+		{
+			__foreach_this_hash_map_it(it)
+			{
+				if (!condition_function(it->first, it->second))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/// @brief Returns a new HashMap with all keys and values cast into the type L and S.
+		/// @return A new HashMap with all keys and values cast into the type L and S.
+		/// @note Make sure all keys can be cast into type L and all values into type S.
+		template <class L, class S>
+		HashMap<L, S> cast() const
+		{
+			HashMap<L, S> result;
+			__foreach_this_hash_map_it(it)
+			{
+				result[(L)it->first] = (S)it->second;
+			}
+			return result;
+		}
+		/// @brief Finds and returns value stored at key. In case no value is found, returns the given default value.
+		/// @param[in] key Key to retrieve the value of.
+		/// @param[in] defaultValue Default value to return if key does not exist.
+		/// @return Value stored at key or given default value.
+		V try_get_by_key(K key, V defaultValue) const
+		{
+			iterator_map_t it = stdhashmap::find(key);
+			return (it != stdhashmap::end() ? it->second : defaultValue);
+		}
+		/// @brief Same as insert.
+		/// @see insert(const HashMap<K, V>& other)
+		HashMap<K, V>& operator+=(const HashMap<K, V>& other)
+		{
+			this->insert(other);
+			return (*this);
+		}
+		/// @brief Merges two HashMaps.
+		/// @param[in] other Second HashMap to merge with.
+		/// @return New HashMap with elements of both HashMaps.
+		/// @note Entries with already existing keys in the first HashMap will not be overwritten.
+		HashMap<K, V> operator+(const HashMap<K, V>& other) const
+		{
+			HashMap<K, V> result(*this);
+			result += other;
+			return result;
+		}
+
+	};
+
+}
+
+/// @brief Alias for simpler code.
+#define hhashmap hltypes::HashMap
+
+#endif
@@ -21,6 +21,7 @@
 
 namespace hltypes
 {
+	class Thread;
 	/// @brief Provides high level logging.
 	class hltypesExport Log
 	{
@@ -65,7 +66,12 @@ namespace hltypes
 		/// @brief Sets the current tag filters.
 		/// @param[in] value New tag filters.
 		/// @note If value is an empty Array, the no filtering will be used.
-		static void setTagFilters(Array<String> value) { tag_filters = value; }
+		static void setTagFilters(Array<String> value);
+		/// @brief Checks if a message with the given tag and log level would be logged.
+		/// @param[in] tag The message tag.
+		/// @param[in] level The log level.
+		/// @return True if the log level is turned on and the tag is allowed.
+		static bool isAllowed(const String& tag, int level);
 		/// @brief Sets all logging levels at once.
 		/// @param[in] write Value for Log level Write.
 		/// @param[in] write Value for Log level Error.
@@ -79,8 +85,35 @@ namespace hltypes
 		static void setFilename(const String& filename, bool clearFile = true);
 		/// @brief Sets the callback function that is called after logging.
 		/// @param[in] function Callback function.
-		/// @note The callback is called in a thread-safe manner.
+		/// @note The callback is never called from multiple threads at the same time and gets messages in the order they were logged.
+		/// @note The callback is called without holding any lock, possibly from the thread of another message that is currently calling
+		/// it or from the background thread of asynchronous logging. Messages logged from the callback never wait for space in the queue.
 		static void setCallbackFunction(void (*function)(const String&, const String&)) { callback_function = function; }
+		/// @brief Checks if asynchronous logging is turned on.
+		/// @return True if asynchronous logging is turned on.
+		static bool isAsync();
+		/// @brief Turns asynchronous logging on or off.
+		/// @param[in] value Whether to turn it on or off.
+		/// @note When turned on, messages are queued and a background thread handles printing, file dumping and the callback in batches.
+		/// @note When turned off, the background thread is stopped after all queued messages have been processed.
+		/// @note Asynchronous logging should be turned off before the application exits.
+		static void setAsync(bool value);
+		/// @brief Gets the maximum number of queued messages in asynchronous logging.
+		/// @return The maximum number of queued messages.
+		static int getQueueSize();
+		/// @brief Sets the maximum number of queued messages in asynchronous logging.
+		/// @param[in] value New value.
+		/// @note Values less than 1 are treated as 1.
+		static void setQueueSize(int value);
+		/// @brief Checks if messages are dropped when the queue is full in asynchronous logging.
+		/// @return True if messages are dropped when the queue is full.
+		static bool isDropWhenFull();
+		/// @brief Sets whether messages are dropped when the queue is full in asynchronous logging.
+		/// @param[in] value Whether messages should be dropped instead of waiting for free space in the queue.
+		static void setDropWhenFull(bool value);
+		/// @brief Gets the number of messages that were dropped because the queue was full.
+		/// @return Number of dropped messages.
+		static int getDroppedCount();
 
 		/// @brief Logs a message on the log level Write.
 		/// @param[in] tag The message tag.
@@ -114,9 +147,14 @@ namespace hltypes
 		/// @brief Same as debug, except with string formatting.
 		/// @see debug
 		static bool debugf(const String& tag, const char* format, ...);
+		/// @brief Processes all queued messages in asynchronous logging before returning.
+		/// @note Does nothing if asynchronous logging is turned off.
+		/// @note When not called from the callback, it also waits until the callback has been called for all processed messages.
+		static void flush();
 		/// @brief Merges all log files into one.
 		/// @param[in] clearFile Set to true if file should be cleared.
 		/// @note Call this at application exit or before changing logging files.
+		/// @note Queued messages in asynchronous logging are processed first.
 		static void finalize(bool clearFile = true);
 
 	protected:
@@ -128,12 +166,24 @@ namespace hltypes
 		static bool level_warn;
 		/// @brief Flag for Debug level logging.
 		static bool level_debug;
-		/// @brief Filters for tags that should be logged.
+		/// @brief Filters for tags that should be logged, sorted by their hashes.
 		static Array<String> tag_filters;
+		/// @brief Sorted hashes of the tag filters for fast lookup.
+		static Array<unsigned long long> tag_filter_hashes;
 		/// @brief Filename for logging to files.
 		static String filename;
 		/// @brief Callback function for logging.
 		static void (*callback_function)(const String&, const String&);
+		/// @brief Flag for asynchronous logging.
+		static bool async;
+		/// @brief Maximum number of queued messages in asynchronous logging.
+		static int queue_size;
+		/// @brief Flag for dropping messages when the queue is full in asynchronous logging.
+		static bool drop_when_full;
+		/// @brief Number of dropped messages in asynchronous logging.
+		static int dropped_count;
+		/// @brief The background thread for asynchronous logging.
+		static Thread* writer_thread;
 
 		/// @brief Executes the actual message loggging.
 		/// @param[in] tag The message tag.
@@ -141,6 +191,23 @@ namespace hltypes
 		/// @param[in] level Log level (required for Android).
 		/// @return True if the message could be logged.
 		static bool _system_log(const String& tag, const String& message, int level);
+		/// @brief Prints a message and appends it to the data for file dumping.
+		/// @param[in] tag The message tag.
+		/// @param[in] message The message to log.
+		/// @param[in] level Log level (required for Android).
+		/// @param[out] data Data for file dumping.
+		static void _output(const String& tag, const String& message, int level, String& data);
+		/// @brief Dumps data to the log file.
+		/// @param[in] data Data for file dumping.
+		static void _dump(const String& data);
+		/// @brief Processes all currently queued messages.
+		/// @return True if there were any queued messages.
+		static bool _process_queue();
+		/// @brief Calls the callback for all messages that are waiting for it, unless another thread is already doing that.
+		static void _deliver_callbacks();
+		/// @brief Background thread function for asynchronous logging.
+		/// @param[in] thread The thread.
+		static void _async_writer(Thread* thread);
 
 	};
 }
@@ -148,5 +215,42 @@ namespace hltypes
 /// @brief Alias for simpler code.
 typedef hltypes::Log hlog;
 
+/// @brief Log level values for the compile-time minimum log level.
+#define HLOG_LEVEL_DEBUG 1
+#define HLOG_LEVEL_WARN 2
+#define HLOG_LEVEL_ERROR 3
+#define HLOG_LEVEL_WRITE 4
+#define HLOG_LEVEL_NONE 5
+
+/// @brief Compile-time minimum log level. Logging macros below this level are compiled out.
+/// @note Define it before including this header or in the project settings.
+#ifndef HLOG_MIN_LEVEL
+#define HLOG_MIN_LEVEL HLOG_LEVEL_DEBUG
+#endif
+
+/// @brief Logging macros that skip formatting and argument evaluation when the log level is turned off.
+/// @note Usage is the same as with the formatting functions, e.g. hlog_debugf(tag, "value: %d", value);
+/// @note Tag filters are applied before formatting as well.
+#if HLOG_MIN_LEVEL <= HLOG_LEVEL_WRITE
+#define hlog_writef if (!hltypes::Log::isLevelWrite()) { } else hltypes::Log::writef
+#else
+#define hlog_writef if (true) { } else hltypes::Log::writef
+#endif
+#if HLOG_MIN_LEVEL <= HLOG_LEVEL_ERROR
+#define hlog_errorf if (!hltypes::Log::isLevelError()) { } else hltypes::Log::errorf
+#else
+#define hlog_errorf if (true) { } else hltypes::Log::errorf
+#endif
+#if HLOG_MIN_LEVEL <= HLOG_LEVEL_WARN
+#define hlog_warnf if (!hltypes::Log::isLevelWarn()) { } else hltypes::Log::warnf
+#else
+#define hlog_warnf if (true) { } else hltypes::Log::warnf
+#endif
+#if HLOG_MIN_LEVEL <= HLOG_LEVEL_DEBUG
+#define hlog_debugf if (!hltypes::Log::isLevelDebug()) { } else hltypes::Log::debugf
+#else
+#define hlog_debugf if (true) { } else hltypes::Log::debugf
+#endif
+
 #endif
 
@@ -19,34 +19,143 @@
 #include <pthread.h>
 #endif
 
+#include "harray.h"
 #include "hltypesExport.h"
+#include "hstring.h"
 
 namespace hltypes
 {
+	class Condition;
+	class ReadWriteMutex;
+	/// @brief Contention statistics of a Mutex.
+	struct hltypesExport MutexStatistics
+	{
+		/// @brief Name of the Mutex.
+		String name;
+		/// @brief How many times the Mutex was locked.
+		unsigned int acquisitions;
+		/// @brief How many times the Mutex was already locked by another thread when trying to lock it.
+		unsigned int contentions;
+		/// @brief Total time in miliseconds spent waiting for the Mutex.
+		double wait_time;
+
+		/// @brief Constructor.
+		MutexStatistics();
+		/// @brief Destructor.
+		~MutexStatistics();
+
+	};
+
 	/// @brief Provides functionality of a Mutex for multithreading.
 	/// @todo Finish the class and fix remaining problems.
 	class hltypesExport Mutex
 	{
 	public:
 		/// @brief Basic constructor.
-		Mutex();
+		/// @param[in] name Name of the Mutex. Named Mutexes can be queried with Mutex::getAllStatistics().
+		Mutex(const String& name = "");
 		/// @brief Destructor.
 		~Mutex();
+		/// @brief Gets the name of the Mutex.
+		/// @return The name of the Mutex.
+		String getName() { return this->name; }
+		/// @brief Checks if the Mutex spins before blocking.
+		/// @return True if the Mutex spins before blocking.
+		bool isAdaptive() { return this->adaptive; }
+		/// @brief Sets whether the Mutex spins before blocking.
+		/// @param[in] value New value.
+		/// @note The number of spins adapts to how long the Mutex was usually held in the past.
+		/// @note Useful for Mutexes that are held only for short periods of time under high contention.
+		/// @note Has no effect on single core machines and on Windows where every attempt to lock the Mutex is a system call.
+		void setAdaptive(bool value);
 		/// @brief Locks the Mutex.
 		/// @note If another thread has lock, the caller thread will wait until the previous thread unlocks it.
 		void lock();
 		/// @brief Unlocks the Mutex.
 		/// @note Use this when you're done with thread-safe sections of your code.
 		void unlock();
+		/// @brief Gets the contention statistics of the Mutex.
+		/// @return The contention statistics of the Mutex.
+		MutexStatistics getStatistics();
+		/// @brief Resets the contention statistics of the Mutex.
+		void resetStatistics();
+
+		/// @brief Checks if contention statistics are recorded.
+		/// @return True if contention statistics are recorded.
+		static bool isStatisticsEnabled() { return statistics_enabled; }
+		/// @brief Sets whether contention statistics are recorded for all Mutexes.
+		/// @param[in] value New value.
+		/// @note Recording statistics adds a small overhead to every lock() call.
+		static void setStatisticsEnabled(bool value) { statistics_enabled = value; }
+		/// @brief Gets the contention statistics of all named Mutexes.
+		/// @return The contention statistics of all named Mutexes.
+		/// @note The Mutexes are not locked so the values of Mutexes that are locked at the same time can be slightly out of date.
+		static Array<MutexStatistics> getAllStatistics();
 		
 	protected:
 		/// @brief Mutex OS handle.
 		void* handle;
+		/// @brief Name of the Mutex.
+		String name;
+		/// @brief Whether the Mutex spins before blocking.
+		bool adaptive;
+		/// @brief Estimate of the number of spins needed to acquire the Mutex.
+		int spin_estimate;
+		/// @brief Whether the Mutex is currently locked.
+		/// @note Only a hint for spinning that is read without locking.
+		volatile bool held;
+		/// @brief Contention statistics.
+		/// @note Only changed while the Mutex is locked.
+		MutexStatistics statistics;
+
+		/// @brief Tries to lock the Mutex without waiting.
+		/// @return True if the Mutex was locked.
+		bool _try_lock();
+		/// @brief Locks the Mutex by waiting for it.
+		void _lock();
+
+		/// @brief Flag for recording contention statistics.
+		static bool statistics_enabled;
 		
 	};
+
+	/// @brief Keeps a lock during its lifetime.
+	/// @note Works with Mutex, Condition and ReadWriteMutex.
+	class hltypesExport ScopeLock
+	{
+	public:
+		/// @brief Constructor that locks a Mutex.
+		/// @param[in] mutex The Mutex.
+		ScopeLock(Mutex* mutex);
+		/// @brief Constructor that locks a Condition.
+		/// @param[in] condition The Condition.
+		ScopeLock(Condition* condition);
+		/// @brief Constructor that locks a ReadWriteMutex.
+		/// @param[in] rw_mutex The ReadWriteMutex.
+		/// @param[in] write Whether to lock for writing or for reading.
+		ScopeLock(ReadWriteMutex* rw_mutex, bool write = false);
+		/// @brief Destructor.
+		/// @note Unlocks the lock if it wasn't released already.
+		~ScopeLock();
+		/// @brief Unlocks the lock before the end of the scope.
+		void release();
+
+	protected:
+		/// @brief The locked Mutex.
+		Mutex* mutex;
+		/// @brief The locked Condition.
+		Condition* condition;
+		/// @brief The locked ReadWriteMutex.
+		ReadWriteMutex* rw_mutex;
+		/// @brief Whether the ReadWriteMutex is locked for writing.
+		bool write;
+
+	};
 }
 
 /// @brief Alias for simpler code.
 typedef hltypes::Mutex hmutex;
+/// @brief Alias for simpler code.
+typedef hltypes::ScopeLock hscopelock;
 
 #endif
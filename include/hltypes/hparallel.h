@@ -0,0 +1,606 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+/// 
+/// @section DESCRIPTION
+/// 
+/// Provides parallel versions of Array algorithms.
+
+#ifndef HLTYPES_PARALLEL_H
+#define HLTYPES_PARALLEL_H
+
+#include <algorithm>
+#include <vector>
+
+#include "harray.h"
+#include "hltypesExport.h"
+#include "hltypesUtil.h"
+#include "hthreadpool.h"
+
+namespace hltypes
+{
+	/// @brief Provides parallel versions of Array algorithms.
+	/// @note The work is split into parts that are executed on a ThreadPool while the calling thread executes one part itself.
+	/// Arrays smaller than the minimum size are processed sequentially.
+	/// @note Callback functions are called from multiple threads at the same time. They may call parallel algorithms themselves.
+	/// @note Results are the same as the ones of the sequential Array methods.
+	class hltypesExport Parallel
+	{
+	public:
+		/// @brief Gets the minimum number of elements for parallel processing.
+		/// @return The minimum number of elements for parallel processing.
+		static int getMinimumSize();
+		/// @brief Sets the minimum number of elements for parallel processing.
+		/// @param[in] value The minimum number of elements for parallel processing.
+		static void setMinimumSize(int value);
+		/// @brief Gets the ThreadPool that is used for parallel processing.
+		/// @return The ThreadPool or NULL if only one CPU core is available.
+		/// @note By default a shared ThreadPool with one worker less than the number of CPU cores is created when first needed.
+		static ThreadPool* getThreadPool();
+		/// @brief Sets the ThreadPool that is used for parallel processing.
+		/// @param[in] value The ThreadPool or NULL to use the shared ThreadPool.
+		/// @note Tasks of the ThreadPool may call parallel algorithms themselves, since workers execute queued tasks while waiting.
+		static void setThreadPool(ThreadPool* value);
+
+		/// @brief Sorts elements in an Array.
+		/// @param[in] array The Array.
+		/// @note The sorting order is ascending and the sort is stable.
+		template <class T>
+		static void sort(Array<T>& array)
+		{
+			_sort(array, &_less<T>);
+		}
+		/// @brief Sorts elements in an Array.
+		/// @param[in] array The Array.
+		/// @param[in] compare_function Function pointer with comparison function that takes two elements of type T and returns bool.
+		/// @note The sorting order is ascending and the sort is stable.
+		/// @note compare_function should return true if first element is less than the second element.
+		template <class T>
+		static void sort(Array<T>& array, bool (*compare_function)(T, T))
+		{
+			_sort(array, compare_function);
+		}
+		/// @brief Creates new sorted Array.
+		/// @param[in] array The Array.
+		/// @return A new Array.
+		/// @note The sorting order is ascending and the sort is stable.
+		template <class T>
+		static Array<T> sorted(const Array<T>& array)
+		{
+			Array<T> result(array);
+			_sort(result, &_less<T>);
+			return result;
+		}
+		/// @brief Creates new sorted Array.
+		/// @param[in] array The Array.
+		/// @param[in] compare_function Function pointer with comparison function that takes two elements of type T and returns bool.
+		/// @return A new Array.
+		/// @note The sorting order is ascending and the sort is stable.
+		/// @note compare_function should return true if first element is less than the second element.
+		template <class T>
+		static Array<T> sorted(const Array<T>& array, bool (*compare_function)(T, T))
+		{
+			Array<T> result(array);
+			_sort(result, compare_function);
+			return result;
+		}
+		/// @brief Finds and returns new Array of elements that match the condition.
+		/// @param[in] array The Array.
+		/// @param[in] condition_function Function pointer with condition function that takes one element of type T and returns bool.
+		/// @return New Array with all matching elements in their original order.
+		template <class T>
+		static Array<T> find_all(const Array<T>& array, bool (*condition_function)(T))
+		{
+			FindAllData<T> data(array, condition_function, _get_part_count(array.size()));
+			_run(data, data.parts);
+			Array<T> result;
+			int size = 0;
+			for_iter (i, 0, data.parts)
+			{
+				size += data.results[i].size();
+			}
+			result.reserve(size);
+			for_iter (i, 0, data.parts)
+			{
+				result.insert(result.end(), data.results[i].begin(), data.results[i].end());
+			}
+			return result;
+		}
+		/// @brief Counts elements that match the condition.
+		/// @param[in] array The Array.
+		/// @param[in] condition_function Function pointer with condition function that takes one element of type T and returns bool.
+		/// @return Number of matching elements.
+		template <class T>
+		static int count(const Array<T>& array, bool (*condition_function)(T))
+		{
+			CountData<T> data(array, condition_function, _get_part_count(array.size()));
+			_run(data, data.parts);
+			int result = 0;
+			for_iter (i, 0, data.parts)
+			{
+				result += data.results[i];
+			}
+			return result;
+		}
+		/// @brief Creates a new Array with the results of a function applied to every element.
+		/// @param[in] array The Array.
+		/// @param[in] function Function pointer with function that takes one element of type T and returns a value of type S.
+		/// @return New Array with the results in the same order.
+		template <class T, class S>
+		static Array<S> map(const Array<T>& array, S (*function)(T))
+		{
+			MapData<T, S> data(array, function, _get_part_count(array.size()));
+			_run(data, data.parts);
+			Array<S> result;
+			result.reserve(array.size());
+			for_iter (i, 0, data.parts)
+			{
+				result.insert(result.end(), data.results[i].begin(), data.results[i].end());
+			}
+			return result;
+		}
+		/// @brief Combines all elements into one value.
+		/// @param[in] array The Array.
+		/// @param[in] function Function pointer with function that combines two values of type T into one.
+		/// @param[in] initial Value that is combined with the first element.
+		/// @return The combined value or the initial value if the Array is empty.
+		/// @note function has to be associative since parts of the Array are combined separately, but it does not have to be commutative.
+		template <class T>
+		static T reduce(const Array<T>& array, T (*function)(T, T), T initial)
+		{
+			ReduceData<T> data(array, function, _get_part_count(array.size()));
+			_run(data, data.parts);
+			T result = initial;
+			for_iter (i, 0, data.parts)
+			{
+				if (data.results[i].size() > 0)
+				{
+					result = function(result, data.results[i][0]);
+				}
+			}
+			return result;
+		}
+		/// @brief Randomizes order of elements in an Array.
+		/// @param[in] array The Array.
+		/// @note Every element is moved to a random bucket in parallel and then every bucket is shuffled in parallel.
+		template <class T>
+		static void randomize(Array<T>& array)
+		{
+			int parts = _get_part_count(array.size());
+			if (parts <= 1)
+			{
+				array.randomize();
+				return;
+			}
+			RandomizeData<T> data(array, parts);
+			data.phase = RandomizeData<T>::ASSIGN;
+			_run(data, parts);
+			// every part writes the elements of every bucket into its own range
+			int offset = 0;
+			for_iter (i, 0, parts)
+			{
+				data.bucketBounds[i] = offset;
+				for_iter (j, 0, parts)
+				{
+					data.offsets[j * parts + i] = offset;
+					offset += data.counts[j * parts + i];
+				}
+			}
+			data.bucketBounds[parts] = offset;
+			data.phase = RandomizeData<T>::SCATTER;
+			_run(data, parts);
+			data.phase = RandomizeData<T>::SHUFFLE;
+			_run(data, parts);
+			array.swap(data.buffer);
+		}
+		/// @brief Creates a new Array with randomized order of elements.
+		/// @param[in] array The Array.
+		/// @return A new Array.
+		template <class T>
+		static Array<T> randomized(const Array<T>& array)
+		{
+			Array<T> result(array);
+			randomize(result);
+			return result;
+		}
+
+	protected:
+		/// @brief Executes one index of a parallel operation.
+		template <class F> class PartTask : public Task
+		{
+		public:
+			F* data;
+			int index;
+
+			PartTask() : Task(), data(NULL), index(0)
+			{
+			}
+			void execute()
+			{
+				(*this->data)(this->index);
+			}
+
+		};
+
+		/// @brief Splits an Array into parts of roughly the same size.
+		template <class T> struct Parts
+		{
+			const T* elements;
+			int size;
+			int parts;
+
+			Parts(const Array<T>& array, int parts) : elements(array.size() > 0 ? &array.front() : NULL), size(array.size()), parts(parts)
+			{
+			}
+			int begin(int index) const
+			{
+				return (int)((long long)this->size * index / this->parts);
+			}
+			int end(int index) const
+			{
+				return (int)((long long)this->size * (index + 1) / this->parts);
+			}
+
+		};
+
+		template <class T> struct FindAllData : public Parts<T>
+		{
+			bool (*condition_function)(T);
+			std::vector<std::vector<T> > results;
+
+			FindAllData(const Array<T>& array, bool (*condition_function)(T), int parts) : Parts<T>(array, parts), condition_function(condition_function), results(parts)
+			{
+			}
+			void operator()(int index)
+			{
+				std::vector<T>& result = this->results[index];
+				int end = this->end(index);
+				for_iter (i, this->begin(index), end)
+				{
+					if (this->condition_function(this->elements[i]))
+					{
+						result.push_back(this->elements[i]);
+					}
+				}
+			}
+
+		};
+
+		template <class T> struct CountData : public Parts<T>
+		{
+			bool (*condition_function)(T);
+			std::vector<int> results;
+
+			CountData(const Array<T>& array, bool (*condition_function)(T), int parts) : Parts<T>(array, parts), condition_function(condition_function), results(parts, 0)
+			{
+			}
+			void operator()(int index)
+			{
+				int result = 0;
+				int end = this->end(index);
+				for_iter (i, this->begin(index), end)
+				{
+					if (this->condition_function(this->elements[i]))
+					{
+						++result;
+					}
+				}
+				this->results[index] = result;
+			}
+
+		};
+
+		template <class T, class S> struct MapData : public Parts<T>
+		{
+			S (*function)(T);
+			std::vector<std::vector<S> > results;
+
+			MapData(const Array<T>& array, S (*function)(T), int parts) : Parts<T>(array, parts), function(function), results(parts)
+			{
+			}
+			void operator()(int index)
+			{
+				std::vector<S>& result = this->results[index];
+				int end = this->end(index);
+				result.reserve(end - this->begin(index));
+				for_iter (i, this->begin(index), end)
+				{
+					result.push_back(this->function(this->elements[i]));
+				}
+			}
+
+		};
+
+		template <class T> struct ReduceData : public Parts<T>
+		{
+			T (*function)(T, T);
+			// a part's result is empty if the part has no elements
+			std::vector<std::vector<T> > results;
+
+			ReduceData(const Array<T>& array, T (*function)(T, T), int parts) : Parts<T>(array, parts), function(function), results(parts)
+			{
+			}
+			void operator()(int index)
+			{
+				int begin = this->begin(index);
+				int end = this->end(index);
+				if (begin < end)
+				{
+					T result = this->elements[begin];
+					for_iter (i, begin + 1, end)
+					{
+						result = this->function(result, this->elements[i]);
+					}
+					this->results[index].push_back(result);
+				}
+			}
+
+		};
+
+		template <class T, class C> struct SortData
+		{
+			enum Phase
+			{
+				SORT,
+				MERGE
+			};
+
+			/// @brief A range of the output that is merged from two sorted ranges.
+			struct Piece
+			{
+				int first;
+				int firstEnd;
+				int second;
+				int secondEnd;
+				int output;
+			};
+
+			T* source;
+			T* destination;
+			C compare;
+			Phase phase;
+			std::vector<int> bounds;
+			std::vector<Piece> pieces;
+
+			SortData(C compare) : source(NULL), destination(NULL), compare(compare), phase(SORT)
+			{
+			}
+			void operator()(int index)
+			{
+				if (this->phase == SORT)
+				{
+					std::stable_sort(this->source + this->bounds[index], this->source + this->bounds[index + 1], this->compare);
+				}
+				else
+				{
+					Piece& piece = this->pieces[index];
+					std::merge(this->source + piece.first, this->source + piece.firstEnd, this->source + piece.second,
+						this->source + piece.secondEnd, this->destination + piece.output, this->compare);
+				}
+			}
+			/// @brief Finds how many of the first count merged elements come from the first range.
+			/// @note Elements from the first range come first if they are equal to keep the merge stable.
+			int co_rank(const T* first, int firstSize, const T* second, int secondSize, int count) const
+			{
+				int low = hmax(0, count - secondSize);
+				int high = hmin(count, firstSize);
+				int middle = 0;
+				while (low < high)
+				{
+					middle = (low + high) / 2;
+					if (!this->compare(second[count - middle - 1], first[middle]))
+					{
+						low = middle + 1;
+					}
+					else
+					{
+						high = middle;
+					}
+				}
+				return low;
+			}
+			/// @brief Splits the merging of two neighboring sorted ranges into a number of pieces.
+			void add_pieces(int first, int second, int end, int count)
+			{
+				int firstSize = second - first;
+				int secondSize = end - second;
+				int size = firstSize + secondSize;
+				Piece piece;
+				int done = 0;
+				int doneFirst = 0;
+				int next = 0;
+				int nextFirst = 0;
+				for_iter (i, 1, count + 1)
+				{
+					next = (int)((long long)size * i / count);
+					nextFirst = (i < count ? this->co_rank(this->source + first, firstSize, this->source + second, secondSize, next) : firstSize);
+					piece.first = first + doneFirst;
+					piece.firstEnd = first + nextFirst;
+					piece.second = second + (done - doneFirst);
+					piece.secondEnd = second + (next - nextFirst);
+					piece.output = first + done;
+					this->pieces.push_back(piece);
+					done = next;
+					doneFirst = nextFirst;
+				}
+			}
+
+		};
+
+		template <class T> struct RandomizeData : public Parts<T>
+		{
+			enum Phase
+			{
+				ASSIGN,
+				SCATTER,
+				SHUFFLE
+			};
+
+			Phase phase;
+			std::vector<T> buffer;
+			/// @brief Bucket of every element.
+			std::vector<int> buckets;
+			/// @brief Number of elements of every part in every bucket.
+			std::vector<int> counts;
+			/// @brief Next output index of every part in every bucket.
+			std::vector<int> offsets;
+			std::vector<int> bucketBounds;
+			std::vector<unsigned long long> seeds;
+
+			RandomizeData(const Array<T>& array, int parts) : Parts<T>(array, parts), phase(ASSIGN), buffer(array.begin(), array.end()),
+				buckets(array.size()), counts(parts * parts, 0), offsets(parts * parts, 0), bucketBounds(parts + 1, 0), seeds(parts * 2)
+			{
+				for_iter (i, 0, parts * 2)
+				{
+					// the sequential random generator is only used on the calling thread
+					this->seeds[i] = (((unsigned long long)hrand(0x7FFFFFFF) << 32) ^ (unsigned long long)hrand(0x7FFFFFFF)) | 1;
+				}
+			}
+			static unsigned int _random(unsigned long long& state, unsigned int max)
+			{
+				// xorshift64*
+				state ^= state >> 12;
+				state ^= state << 25;
+				state ^= state >> 27;
+				unsigned long long value = (state * 0x2545F4914F6CDD1DULL) >> 32;
+				return (unsigned int)((value * max) >> 32);
+			}
+			void operator()(int index)
+			{
+				int begin = this->begin(index);
+				int end = this->end(index);
+				if (this->phase == ASSIGN)
+				{
+					unsigned long long state = this->seeds[index];
+					int* counts = &this->counts[index * this->parts];
+					int bucket = 0;
+					for_iter (i, begin, end)
+					{
+						bucket = (int)_random(state, this->parts);
+						this->buckets[i] = bucket;
+						++counts[bucket];
+					}
+				}
+				else if (this->phase == SCATTER)
+				{
+					int* offsets = &this->offsets[index * this->parts];
+					for_iter (i, begin, end)
+					{
+						this->buffer[offsets[this->buckets[i]]++] = this->elements[i];
+					}
+				}
+				else
+				{
+					unsigned long long state = this->seeds[this->parts + index];
+					begin = this->bucketBounds[index];
+					end = this->bucketBounds[index + 1];
+					for_iter_r (i, end - begin, 1)
+					{
+						std::swap(this->buffer[begin + i], this->buffer[begin + _random(state, i + 1)]);
+					}
+				}
+			}
+
+		};
+
+		template <class T>
+		static bool _less(T a, T b)
+		{
+			return (a < b);
+		}
+		/// @brief Gets the number of parts an Array should be split into.
+		/// @param[in] size Size of the Array.
+		/// @return The number of parts or 1 if the Array should be processed sequentially.
+		static int _get_part_count(int size);
+		/// @brief Executes a parallel operation for indexes from 0 to count - 1.
+		/// @param[in] data The operation.
+		/// @param[in] count Number of indexes.
+		/// @note Index 0 is executed by the calling thread.
+		template <class F>
+		static void _run(F& data, int count)
+		{
+			ThreadPool* pool = getThreadPool();
+			if (pool == NULL || count <= 1)
+			{
+				for_iter (i, 0, count)
+				{
+					data(i);
+				}
+				return;
+			}
+			PartTask<F>* tasks = new PartTask<F>[count - 1];
+			for_iter (i, 0, count - 1)
+			{
+				tasks[i].data = &data;
+				tasks[i].index = i + 1;
+				pool->submit(&tasks[i]);
+			}
+			data(0);
+			// when called from a worker of the pool, waiting executes queued parts instead of blocking the worker
+			for_iter (i, 0, count - 1)
+			{
+				tasks[i].wait();
+			}
+			delete [] tasks;
+		}
+		template <class T, class C>
+		static void _sort(Array<T>& array, C compare)
+		{
+			int size = array.size();
+			int parts = _get_part_count(size);
+			if (parts <= 1)
+			{
+				std::stable_sort(array.begin(), array.end(), compare);
+				return;
+			}
+			// chunks are only split once per thread since every merge round goes through all elements again
+			ThreadPool* pool = getThreadPool();
+			int threads = (pool != NULL ? hmin(parts, pool->getWorkerCount() + 1) : 1);
+			// a power of 2 keeps the merge rounds balanced
+			parts = 1;
+			while (parts < threads)
+			{
+				parts *= 2;
+			}
+			SortData<T, C> data(compare);
+			std::vector<T> buffer(array.begin(), array.end());
+			data.source = &array.front();
+			data.destination = &buffer.front();
+			for_iter (i, 0, parts + 1)
+			{
+				data.bounds.push_back((int)((long long)size * i / parts));
+			}
+			_run(data, parts);
+			data.phase = SortData<T, C>::MERGE;
+			int pairs = 0;
+			for (int width = 1; width < parts; width *= 2)
+			{
+				// merging is split into more pieces when fewer pairs are left so all threads stay busy
+				pairs = parts / (width * 2);
+				data.pieces.clear();
+				for_iter (i, 0, pairs)
+				{
+					data.add_pieces(data.bounds[i * width * 2], data.bounds[i * width * 2 + width], data.bounds[(i + 1) * width * 2], hmax(1, threads / pairs));
+				}
+				_run(data, data.pieces.size());
+				std::swap(data.source, data.destination);
+			}
+			if (data.source != &array.front())
+			{
+				array.swap(buffer);
+			}
+		}
+
+	};
+
+}
+
+/// @brief Alias for simpler code.
+typedef hltypes::Parallel hparallel;
+
+#endif
@@ -64,6 +64,13 @@
 #endif
 #endif
 
+// variables with this storage class have a separate instance on every thread
+#ifdef _MSC_VER
+#define _HL_THREAD_LOCAL __declspec(thread)
+#else
+#define _HL_THREAD_LOCAL __thread
+#endif
+
 #include "hstring.h"
 
 namespace hltypes
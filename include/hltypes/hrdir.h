@@ -20,6 +20,7 @@
 #include "hltypesExport.h"
 #include "hmap.h"
 #include "hresource.h"
+#include "hrwmutex.h"
 #include "hstring.h"
 
 namespace hltypes
@@ -63,10 +64,14 @@ namespace hltypes
 	protected:
 		/// @brief Cache for directory entries.
 		/// @note This is usually only used when ZIP resources are being used.
+		/// @note Filled from the archive index and cleared when the archive changes.
 		static Map<String, Array<String> > cacheDirectories;
 		/// @brief Cache for file entries.
 		/// @note This is usually only used when ZIP resources are being used.
+		/// @note Filled from the archive index and cleared when the archive changes.
 		static Map<String, Array<String> > cacheFiles;
+		/// @brief Guards the caches so they can be read concurrently.
+		static ReadWriteMutex cacheMutex;
 
 		/// @brief Basic constructor.
 		/// @note Forces this to be a static class.
@@ -85,6 +85,23 @@ namespace hltypes
 		/// @brief Gets the resource archive's filename.
 		/// @return Resource archive's filename.
 		static bool hasZip();
+		/// @brief Gets the maximum size in bytes of decompressed files that are kept in memory.
+		/// @return Maximum size in bytes of decompressed files that are kept in memory.
+		/// @note This is only used when ZIP resources are being used.
+		static long getCacheSize();
+		/// @brief Sets the maximum size in bytes of decompressed files that are kept in memory.
+		/// @param[in] value New value. If 0, no files are kept in memory.
+		/// @note This is only used when ZIP resources are being used.
+		/// @note Files larger than a quarter of the cache size are only cached when preloaded.
+		/// @note The least recently used files are removed when the cache is full.
+		static void setCacheSize(long value);
+		/// @brief Removes all decompressed files from the cache.
+		static void clearCache();
+		/// @brief Decompresses files in parallel and keeps them in the cache.
+		/// @param[in] filenames Names of the resource files.
+		/// @note Does nothing if the cache size is 0.
+		/// @note Uses the ThreadPool of Parallel. Files are decompressed one after another if there is none.
+		static void preload(const Array<String>& filenames);
 
 	protected:
 		/// @brief Data position;
@@ -0,0 +1,55 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+/// 
+/// @section DESCRIPTION
+/// 
+/// Provides functionality of a read-write mutex for multithreading.
+
+#ifndef HLTYPES_READ_WRITE_MUTEX_H
+#define HLTYPES_READ_WRITE_MUTEX_H
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "hltypesExport.h"
+
+namespace hltypes
+{
+	/// @brief Provides functionality of a read-write mutex for multithreading.
+	/// @note Multiple threads can hold the read lock at the same time while the write lock is exclusive.
+	/// @note The locks are not recursive.
+	/// @note Requires Windows Vista or later on Windows.
+	class hltypesExport ReadWriteMutex
+	{
+	public:
+		/// @brief Basic constructor.
+		ReadWriteMutex();
+		/// @brief Destructor.
+		~ReadWriteMutex();
+		/// @brief Locks the ReadWriteMutex for reading.
+		void lock_read();
+		/// @brief Unlocks the ReadWriteMutex after reading.
+		void unlock_read();
+		/// @brief Locks the ReadWriteMutex for writing.
+		void lock_write();
+		/// @brief Unlocks the ReadWriteMutex after writing.
+		void unlock_write();
+
+	protected:
+		/// @brief Read-write lock OS handle.
+		void* handle;
+
+	};
+}
+
+/// @brief Alias for simpler code.
+typedef hltypes::ReadWriteMutex hrwmutex;
+
+#endif
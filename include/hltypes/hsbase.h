@@ -23,10 +23,13 @@
 namespace hltypes
 {
 	template <class T> class Array;
+	class LineCursor;
 	/// @brief Provides a base class for streaming.
 	class hltypesExport StreamBase
 	{
 	public:
+		friend class LineCursor;
+
 		/// @brief Defines file seek modes.
 		enum SeekMode
 		{
@@ -80,6 +83,7 @@ namespace hltypes
 		/// @brief Reads all lines from the stream.
 		/// @return Array with read lines.
 		/// @note \\n is not included in the read lines.
+		/// @note Use LineCursor to process big streams line by line without keeping all lines in memory.
 		Array<String> read_lines();
 		/// @brief Writes string to the stream.
 		/// @param[in] text String to write.
@@ -198,15 +202,89 @@ namespace hltypes
 		/// @brief Loads data from file in a platform-aware format.
 		/// @return Loaded String.
 		String load_string();
+		/// @brief Dumps an array of elements in a platform-aware format with a single write.
+		/// @param[in] data Pointer to the elements.
+		/// @param[in] count Number of elements.
+		/// @note T must be an arithmetic type. Elements are stored in little endian byte order.
+		template <class T>
+		void dump_array(const T* data, int count)
+		{
+			this->_dump_elements(data, sizeof(T), count);
+		}
+		/// @brief Dumps an Array's size and its elements in a platform-aware format.
+		/// @param[in] data The Array.
+		/// @note T must be an arithmetic type. Elements are stored in little endian byte order.
+		template <class T>
+		void dump_array(const Array<T>& data)
+		{
+			int count = data.size();
+			this->begin_batch();
+			this->dump(count);
+			if (count > 0)
+			{
+				this->_dump_elements(&data[0], sizeof(T), count);
+			}
+			this->end_batch();
+		}
+		/// @brief Loads an array of elements in a platform-aware format with a single read.
+		/// @param[out] data Pointer to the destination buffer.
+		/// @param[in] count Number of elements.
+		/// @return Number of elements loaded.
+		/// @note T must be an arithmetic type.
+		template <class T>
+		int load_array(T* data, int count)
+		{
+			return this->_load_elements(data, sizeof(T), count);
+		}
+		/// @brief Loads an Array that was dumped with dump_array(const Array<T>& data).
+		/// @return Loaded Array.
+		/// @note T must be an arithmetic type.
+		template <class T>
+		Array<T> load_array()
+		{
+			Array<T> result;
+			int count = this->load_int();
+			if (count > 0)
+			{
+				result.resize(count);
+				result.resize(this->_load_elements(&result[0], sizeof(T), count));
+			}
+			return result;
+		}
+		/// @brief Starts a write batch that defers internal data size updates until the batch ends.
+		/// @note Batches can be nested. Use WriteBatch to make sure a batch always ends.
+		/// @note size() and eof() still work properly during a batch.
+		void begin_batch();
+		/// @brief Ends a write batch and updates the internal data size if data was written.
+		void end_batch();
 		
 	protected:
 		/// @brief Data size, mostly used for optimization and faster "eof" detection.
 		long data_size;
 		/// @brief Byte value offset while reading/writing that serves as simple binary encryption.
 		unsigned char encryption_offset;
+		/// @brief Current write batch nesting depth.
+		int batch_depth;
+		/// @brief Whether data was written during the current write batch.
+		bool batch_dirty;
 
 		/// @brief Updates internal data size.
 		virtual void _update_data_size();
+		/// @brief Updates internal data size after writing or marks it for an update if a write batch is active.
+		void _data_written();
+		/// @brief Updates internal data size if an update was deferred by a write batch.
+		void _flush_data_size();
+		/// @brief Writes elements with endian conversion.
+		/// @param[in] data Source elements.
+		/// @param[in] element_size Size of a single element in bytes.
+		/// @param[in] count Number of elements.
+		void _dump_elements(const void* data, int element_size, int count);
+		/// @brief Reads elements with endian conversion.
+		/// @param[out] data Destination elements.
+		/// @param[in] element_size Size of a single element in bytes.
+		/// @param[in] count Number of elements.
+		/// @return Number of elements read.
+		int _load_elements(void* data, int element_size, int count);
 		/// @brief Checks if object can be used.
 		virtual void _check_availability();
 
@@ -235,12 +313,88 @@ namespace hltypes
 		/// @param[in] offset Seeking offset in bytes.
 		/// @param[in] seek_mode Seeking mode.
 		virtual void _seek(long offset, SeekMode seek_mode = CURRENT) = 0;
+		/// @brief Gets direct access to the data at the current position if the implementation keeps it in memory.
+		/// @param[out] size Number of bytes available from the current position.
+		/// @return Pointer to the data at the current position or NULL if direct access is not supported.
+		virtual const unsigned char* _direct_data(long& /*size*/) { return NULL; }
+
+	};
+
+	/// @brief Keeps a write batch active on a stream during its lifetime.
+	/// @see StreamBase::begin_batch
+	class hltypesExport WriteBatch
+	{
+	public:
+		/// @brief Constructor.
+		/// @param[in] stream The stream on which the batch is started.
+		WriteBatch(StreamBase* stream) : stream(stream) { this->stream->begin_batch(); }
+		/// @brief Destructor.
+		/// @note Ends the batch.
+		~WriteBatch() { this->stream->end_batch(); }
+
+	protected:
+		/// @brief The batched stream.
+		StreamBase* stream;
+
+	};
+
+	/// @brief Iterates through the lines of a stream without allocating a String for each line.
+	/// @note The line data is only valid until the next call of next() and it is not 0-terminated.
+	/// @note While the cursor is in use, it reads ahead so the stream's position should not be used until the cursor is destroyed.
+	class hltypesExport LineCursor
+	{
+	public:
+		/// @brief Constructor.
+		/// @param[in] stream The stream that will be read line by line from its current position.
+		/// @note The cursor must not outlive the stream.
+		LineCursor(StreamBase* stream);
+		/// @brief Destructor.
+		/// @note Moves the stream's position right behind the last line that was returned.
+		~LineCursor();
+		/// @brief Gets the current line data.
+		/// @return The current line data.
+		const char* getLine() { return this->line; }
+		/// @brief Gets the current line size in bytes.
+		/// @return The current line size in bytes.
+		int getSize() { return this->size; }
+		/// @brief Gets a copy of the current line.
+		/// @return A copy of the current line.
+		String getString() { return String(this->line, this->size); }
+		/// @brief Advances to the next line.
+		/// @return False if there are no more lines.
+		/// @note \n and a trailing \r are not included in the line.
+		bool next();
+
+	protected:
+		/// @brief The stream that is being read.
+		StreamBase* stream;
+		/// @brief Refillable buffer for streams without direct data access.
+		char* buffer;
+		/// @brief Allocated size of the buffer.
+		int capacity;
+		/// @brief Start of the unprocessed data in the buffer.
+		int start;
+		/// @brief End of the unprocessed data in the buffer.
+		int end;
+		/// @brief The current line.
+		const char* line;
+		/// @brief The current line size.
+		int size;
+
+		/// @brief Sets the current line and removes a trailing \r.
+		/// @param[in] data Line data.
+		/// @param[in] size Line size.
+		void _set_line(const char* data, int size);
 
 	};
 }
 
 /// @brief Alias for simpler code.
 typedef hltypes::StreamBase hsbase;
+/// @brief Alias for simpler code.
+typedef hltypes::LineCursor hlcursor;
+/// @brief Alias for simpler code.
+typedef hltypes::WriteBatch hwbatch;
 
 #endif
 
@@ -0,0 +1,57 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+/// 
+/// @section DESCRIPTION
+/// 
+/// Provides functionality of a counting semaphore for multithreading.
+
+#ifndef HLTYPES_SEMAPHORE_H
+#define HLTYPES_SEMAPHORE_H
+
+#include "hcondition.h"
+#include "hltypesExport.h"
+
+namespace hltypes
+{
+	/// @brief Provides functionality of a counting semaphore for multithreading.
+	class hltypesExport Semaphore
+	{
+	public:
+		/// @brief Basic constructor.
+		/// @param[in] count Initial count.
+		Semaphore(int count = 0);
+		/// @brief Destructor.
+		~Semaphore();
+		/// @brief Gets the current count.
+		/// @return The current count.
+		int getCount();
+		/// @brief Decreases the count, waiting until it is greater than 0 first.
+		/// @param[in] timeout Maximum time to wait in miliseconds. If 0 or less, waits without a timeout.
+		/// @return False if the timeout expired.
+		bool acquire(float timeout = 0.0f);
+		/// @brief Decreases the count if it is greater than 0 without waiting.
+		/// @return True if the count was decreased.
+		bool try_acquire();
+		/// @brief Increases the count and wakes up waiting threads.
+		/// @param[in] count By how much the count is increased.
+		void release(int count = 1);
+
+	protected:
+		/// @brief The current count.
+		int count;
+		/// @brief Condition for waiting threads.
+		Condition condition;
+
+	};
+}
+
+/// @brief Alias for simpler code.
+typedef hltypes::Semaphore hsemaphore;
+
+#endif
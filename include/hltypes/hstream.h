@@ -70,6 +70,10 @@ namespace hltypes
 		/// @param[in] offset Seeking offset in bytes.
 		/// @param[in] seek_mode Seeking mode.
 		void _seek(long offset, SeekMode seek_mode = CURRENT);
+		/// @brief Gets direct access to the data at the current position.
+		/// @param[out] size Number of bytes available from the current position.
+		/// @return Pointer to the data at the current position.
+		const unsigned char* _direct_data(long& size);
 
 	};
 }
@@ -19,6 +19,9 @@
 
 #include <stdarg.h>
 #include <string>
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#include <functional>
+#endif
 
 #include "hltypesExport.h"
 
@@ -335,6 +338,11 @@ namespace hltypes
 		/// @brief Same as utf8_size.
 		/// @see utf8_size
 		hltypesMemberExport int utf8_length() const;
+		/// @brief Calculates a fast non-cryptographic 64-bit hash of the String.
+		/// @param[in] seed Seed for the hash.
+		/// @return 64-bit hash value.
+		/// @note Not suitable for security purposes.
+		hltypesMemberExport unsigned long long hash(unsigned long long seed = 0) const;
 		/// @brief Checks if string contains ASCII only characters.
 		/// @return True if String contains only ASCII-7 characters.
 		hltypesMemberExport bool is_ascii() const;
@@ -559,5 +567,20 @@ hstr hltypesFnExport hvsprintf(const char* format, va_list args);
 /// @return Formatted String.
 hstr hltypesFnExport hsprintf(const char* format, ...);
 
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
+namespace std
+{
+	/// @brief Allows String to be used as key in std::unordered_map and std::unordered_set.
+	template <> struct hash<hltypes::String>
+	{
+		size_t operator()(const hltypes::String& s) const
+		{
+			return (size_t)s.hash();
+		}
+
+	};
+}
+#endif
+
 #endif
 
@@ -0,0 +1,151 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+/// 
+/// @section DESCRIPTION
+/// 
+/// Provides a pool of worker threads for executing tasks.
+
+#ifndef HLTYPES_THREAD_POOL_H
+#define HLTYPES_THREAD_POOL_H
+
+#include "harray.h"
+#include "hcondition.h"
+#include "hltypesExport.h"
+#include "hmutex.h"
+
+namespace hltypes
+{
+	class ThreadPool;
+	class ThreadPoolWorker;
+	/// @brief A unit of work that can be executed by a ThreadPool.
+	class hltypesExport Task
+	{
+	public:
+		friend class ThreadPool;
+		friend class ThreadPoolWorker;
+
+		/// @brief Basic constructor.
+		/// @param[in] function Function pointer for the callback.
+		/// @param[in] argument Argument that is passed to the callback.
+		Task(void (*function)(void*) = NULL, void* argument = NULL);
+		/// @brief Destructor.
+		virtual ~Task();
+		/// @brief Gets the argument that is passed to the callback.
+		/// @return The argument that is passed to the callback.
+		void* getArgument() { return this->argument; }
+		/// @brief Checks if the task has finished executing.
+		/// @return True if the task has finished executing.
+		bool isDone();
+		/// @brief Waits until the task has finished executing.
+		/// @note When called from a worker of the ThreadPool that executes the task, the worker executes other queued tasks while
+		/// waiting so tasks can wait for tasks they submitted themselves.
+		void wait();
+		/// @brief Executes the task's function.
+		/// @note Can be overridden in derived classes instead of using a function pointer.
+		virtual void execute();
+
+	protected:
+		/// @brief The callback function of the task.
+		void (*function)(void*);
+		/// @brief Argument that is passed to the callback.
+		void* argument;
+		/// @brief The ThreadPool that the task was submitted to.
+		ThreadPool* pool;
+		/// @brief Flag that determines whether the task has finished executing.
+		bool done;
+		/// @brief Condition for waiting on the done flag.
+		Condition condition;
+
+		/// @brief Executes the task and marks it as done.
+		void _run();
+
+	};
+
+	/// @brief Provides a pool of worker threads that execute tasks.
+	/// @note Every worker has its own task queue. Tasks that are submitted from a worker are queued on that worker, other tasks
+	/// are distributed over all workers. Idle workers steal tasks from the queues of other workers.
+	class hltypesExport ThreadPool
+	{
+	public:
+		friend class Task;
+		friend class ThreadPoolWorker;
+
+		/// @brief Basic constructor.
+		/// @param[in] count Number of worker threads. If 0 or less, the number of available CPU cores is used.
+		ThreadPool(int count = 0);
+		/// @brief Destructor.
+		/// @note Waits until all queued tasks are done.
+		~ThreadPool();
+		/// @brief Gets the number of worker threads.
+		/// @return Number of worker threads.
+		int getWorkerCount() { return this->workers.size(); }
+		/// @brief Queues a task for execution.
+		/// @param[in] task The task.
+		/// @return The same task.
+		/// @note The task is not deleted by the pool and must stay valid until it is done.
+		Task* submit(Task* task);
+		/// @brief Queues a function for execution.
+		/// @param[in] function Function pointer for the callback.
+		/// @param[in] argument Argument that is passed to the callback.
+		/// @return A new task that can be used to wait for the execution.
+		/// @note The returned task has to be deleted by the caller after it is done.
+		Task* submit(void (*function)(void*), void* argument = NULL);
+		/// @brief Waits until all queued tasks are done.
+		/// @note Must not be called from a task of this pool, because that task is not done while it waits.
+		void wait();
+		/// @brief Gets the number of available CPU cores.
+		/// @return Number of available CPU cores.
+		static int getCpuCount();
+
+	protected:
+		/// @brief The worker threads.
+		Array<ThreadPoolWorker*> workers;
+		/// @brief Index of the worker that receives the next task that is not submitted from a worker.
+		int next_worker;
+		/// @brief Guards next_worker.
+		Mutex submit_mutex;
+		/// @brief Number of workers that are waiting for tasks.
+		/// @note Written under work_condition, but read without it so submitting doesn't need a global lock when no worker is idle.
+		volatile int sleeping;
+		/// @brief Flag that tells the workers to stop once all queues are empty.
+		bool stopping;
+		/// @brief Condition for idle workers, guards sleeping and stopping.
+		Condition work_condition;
+		/// @brief Number of threads that are waiting for all tasks to be done.
+		/// @note Written under done_condition, but read without it so finishing a task doesn't need a global lock when nobody waits.
+		volatile int waiting;
+		/// @brief Condition for waiting on all tasks to be done, guards waiting.
+		Condition done_condition;
+
+		/// @brief Gets a task from a worker's own queue or steals one from another worker.
+		/// @param[in] index Index of the worker.
+		/// @param[in] blocking Whether to wait for a task if no tasks are queued.
+		/// @return A task or NULL if no tasks are queued or the pool is stopping.
+		Task* _take_task(int index, bool blocking);
+		/// @brief Looks for a task in the worker's own queue first and then in the queues of other workers.
+		/// @param[in] index Index of the worker.
+		/// @return A task or NULL if no tasks are queued.
+		Task* _find_task(int index);
+		/// @brief Executes a task on a worker and marks it as done.
+		/// @param[in] index Index of the worker.
+		/// @param[in] task The task.
+		void _execute_task(int index, Task* task);
+		/// @brief Counts the tasks that were queued and are not done yet.
+		/// @return Number of tasks that are not done yet.
+		int _count_pending();
+
+	};
+}
+
+/// @brief Alias for simpler code.
+typedef hltypes::Task htask;
+/// @brief Alias for simpler code.
+typedef hltypes::ThreadPool hthreadpool;
+
+#endif
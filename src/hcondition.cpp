@@ -0,0 +1,121 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+
+#if defined(_WIN32) && (!defined(_WIN32_WINNT) || _WIN32_WINNT < 0x0600)
+// condition variables require Windows Vista or later
+#undef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <sys/time.h>
+#endif
+
+#include "hcondition.h"
+#include "hltypesUtil.h"
+#include "hplatform.h"
+
+namespace hltypes
+{
+	Condition::Condition()
+	{
+#ifdef _WIN32
+		this->handle = (CRITICAL_SECTION*)malloc(sizeof(CRITICAL_SECTION));
+#ifndef _WINRT
+		InitializeCriticalSection((CRITICAL_SECTION*)this->handle);
+#else
+		InitializeCriticalSectionEx((CRITICAL_SECTION*)this->handle, 0, 0);
+#endif
+		this->condition = (CONDITION_VARIABLE*)malloc(sizeof(CONDITION_VARIABLE));
+		InitializeConditionVariable((CONDITION_VARIABLE*)this->condition);
+#else
+		this->handle = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
+		pthread_mutex_init((pthread_mutex_t*)this->handle, 0);
+		this->condition = (pthread_cond_t*)malloc(sizeof(pthread_cond_t));
+		pthread_cond_init((pthread_cond_t*)this->condition, 0);
+#endif
+	}
+
+	Condition::~Condition()
+	{
+#ifdef _WIN32
+		DeleteCriticalSection((CRITICAL_SECTION*)this->handle);
+		free((CRITICAL_SECTION*)this->handle);
+		free((CONDITION_VARIABLE*)this->condition);
+#else
+		pthread_cond_destroy((pthread_cond_t*)this->condition);
+		free((pthread_cond_t*)this->condition);
+		pthread_mutex_destroy((pthread_mutex_t*)this->handle);
+		free((pthread_mutex_t*)this->handle);
+#endif
+		this->condition = NULL;
+		this->handle = NULL;
+	}
+
+	void Condition::lock()
+	{
+#ifdef _WIN32
+		EnterCriticalSection((CRITICAL_SECTION*)this->handle);
+#else
+		pthread_mutex_lock((pthread_mutex_t*)this->handle);
+#endif
+	}
+
+	void Condition::unlock()
+	{
+#ifdef _WIN32
+		LeaveCriticalSection((CRITICAL_SECTION*)this->handle);
+#else
+		pthread_mutex_unlock((pthread_mutex_t*)this->handle);
+#endif
+	}
+
+	bool Condition::wait(float timeout)
+	{
+#ifdef _WIN32
+		return (SleepConditionVariableCS((CONDITION_VARIABLE*)this->condition, (CRITICAL_SECTION*)this->handle,
+			(timeout > 0.0f ? (DWORD)timeout : INFINITE)) != 0);
+#else
+		if (timeout <= 0.0f)
+		{
+			return (pthread_cond_wait((pthread_cond_t*)this->condition, (pthread_mutex_t*)this->handle) == 0);
+		}
+		// pthread uses an absolute time for the timeout
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		long long nanoseconds = (long long)now.tv_usec * 1000LL + (long long)(timeout * 1000000.0f);
+		struct timespec time;
+		time.tv_sec = now.tv_sec + (time_t)(nanoseconds / 1000000000LL);
+		time.tv_nsec = (long)(nanoseconds % 1000000000LL);
+		return (pthread_cond_timedwait((pthread_cond_t*)this->condition, (pthread_mutex_t*)this->handle, &time) != ETIMEDOUT);
+#endif
+	}
+
+	void Condition::signal()
+	{
+#ifdef _WIN32
+		WakeConditionVariable((CONDITION_VARIABLE*)this->condition);
+#else
+		pthread_cond_signal((pthread_cond_t*)this->condition);
+#endif
+	}
+
+	void Condition::broadcast()
+	{
+#ifdef _WIN32
+		WakeAllConditionVariable((CONDITION_VARIABLE*)this->condition);
+#else
+		pthread_cond_broadcast((pthread_cond_t*)this->condition);
+#endif
+	}
+
+}
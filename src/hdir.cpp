@@ -9,11 +9,13 @@
 /// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
 
 #include <stdio.h>
+#include <time.h>
 #ifdef _WIN32
 #include <direct.h>
 #include "msvc_dirent.h"
 #else
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #define _mkdir(name) ::mkdir(name, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH)
@@ -29,13 +31,20 @@
 int (*d_rename)(const char* old_name, const char* new_name) = rename;
 
 #include "harray.h"
+#include "hdeque.h"
 #include "hdir.h"
+#include "hdirwatch.h"
 #include "hfile.h"
+#include "hhashmap.h"
 #include "hltypesUtil.h"
+#include "hmutex.h"
+#include "hparallel.h"
 #include "hplatform.h"
 #include "hrdir.h"
 #include "hresource.h"
+#include "hrwmutex.h"
 #include "hstring.h"
+#include "hthreadpool.h"
 
 #ifdef _WIN32
 #ifdef _WINRT
@@ -49,6 +58,126 @@ static hltypes::String winrtcwd = ".";
 namespace hltypes
 {
 	bool Dir::win32FullDirectoryPermissions = true;
+	bool Dir::caseInsensitiveCache = false;
+
+	DirEntry::DirEntry() : type(DirEntry::OTHER), link(false), size(0), modification_time(0)
+	{
+	}
+
+	DirEntry::~DirEntry()
+	{
+	}
+
+	DirWalkOptions::DirWalkOptions() : max_depth(-1), follow_links(false), with_info(false), parallel(false), filter(NULL)
+	{
+	}
+
+	DirWalkOptions::~DirWalkOptions()
+	{
+	}
+
+#ifdef _WIN32
+	static unsigned long _convert_time(const FILETIME& time)
+	{
+		ULARGE_INTEGER ull;
+		ull.LowPart = time.dwLowDateTime;
+		ull.HighPart = time.dwHighDateTime;
+		return (unsigned long)(ull.QuadPart / 10000000ULL - 11644473600ULL);
+	}
+
+	static void _read_entry(DIR* /*dir*/, const String& /*dirname*/, struct dirent* entry, DirEntry& current, bool with_info)
+	{
+		// the find data already contains everything so no additional calls are needed
+		DWORD attributes = entry->data.dwFileAttributes;
+		current.link = ((attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0);
+		if ((attributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+		{
+			current.type = DirEntry::DIRECTORY;
+		}
+		else if ((attributes & FILE_ATTRIBUTE_DEVICE) != 0)
+		{
+			current.type = DirEntry::OTHER;
+		}
+		else
+		{
+			current.type = DirEntry::REGULAR_FILE;
+		}
+		current.size = (with_info ? entry->data.nFileSizeLow : 0);
+		current.modification_time = (with_info ? _convert_time(entry->data.ftLastWriteTime) : 0);
+	}
+#else
+	static int _stat_entry(DIR* dir, const String& dirname, struct dirent* entry, struct stat* stats, bool follow_links)
+	{
+#ifdef AT_FDCWD
+		(void)dirname; // only needed without fstatat()
+		return fstatat(dirfd(dir), entry->d_name, stats, (follow_links ? 0 : AT_SYMLINK_NOFOLLOW));
+#else
+		String path = Dir::join_path(dirname, String(entry->d_name), false);
+		return (follow_links ? stat(path.c_str(), stats) : lstat(path.c_str(), stats));
+#endif
+	}
+
+	static void _read_entry(DIR* dir, const String& dirname, struct dirent* entry, DirEntry& current, bool with_info)
+	{
+		bool check = with_info;
+		current.link = false;
+		struct stat stats;
+#ifdef DT_UNKNOWN
+		switch (entry->d_type)
+		{
+		case DT_DIR:
+			current.type = DirEntry::DIRECTORY;
+			break;
+		case DT_REG:
+			current.type = DirEntry::REGULAR_FILE;
+			break;
+		case DT_LNK: // symbolic links are followed
+			current.link = true;
+			check = true;
+			break;
+		case DT_UNKNOWN: // not all file systems report types
+			current.link = (_stat_entry(dir, dirname, entry, &stats, false) == 0 && S_ISLNK(stats.st_mode));
+			check = true;
+			break;
+		default:
+			current.type = DirEntry::OTHER;
+			break;
+		}
+#else
+		current.link = (_stat_entry(dir, dirname, entry, &stats, false) == 0 && S_ISLNK(stats.st_mode));
+		check = true;
+#endif
+		current.size = 0;
+		current.modification_time = 0;
+		if (check)
+		{
+			if (_stat_entry(dir, dirname, entry, &stats, true) != 0)
+			{
+				current.type = DirEntry::OTHER;
+			}
+			else
+			{
+				if (S_ISDIR(stats.st_mode))
+				{
+					current.type = DirEntry::DIRECTORY;
+				}
+				else if (S_ISREG(stats.st_mode))
+				{
+					current.type = DirEntry::REGULAR_FILE;
+				}
+				else
+				{
+					current.type = DirEntry::OTHER;
+				}
+				if (with_info)
+				{
+					current.size = (unsigned long)stats.st_size;
+					current.modification_time = (unsigned long)stats.st_mtime;
+				}
+			}
+		}
+	}
+#endif
 
 #if defined(_WIN32) && defined(_MSC_VER) && !defined(_WINRT) // god help us all
 	static bool _mkdirWin32FullPermissions(const String& path)
@@ -169,13 +298,141 @@ namespace hltypes
 		return (Dir::create(dirname) || Dir::clear(dirname));
 	}
 	
-	bool Dir::remove(const String& dirname)
+	/// @brief Paths of a directory tree that are processed on multiple threads.
+	struct DirTree
+	{
+		/// @brief Whether symbolic links to directories are entered or treated like files.
+		bool follow_links;
+		Array<String> directories;
+		Array<String> files;
+		/// @brief Symbolic links to directories that were not entered.
+		Array<String> links;
+
+		DirTree(bool follow_links) : follow_links(follow_links)
+		{
+		}
+
+	};
+
+	static void _add_tree_entry(const DirEntry& entry, void* argument)
+	{
+		DirTree* tree = (DirTree*)argument;
+		if (entry.type != DirEntry::DIRECTORY)
+		{
+			tree->files += entry.name;
+		}
+		else if (tree->follow_links || !entry.link)
+		{
+			tree->directories += entry.name;
+		}
+		else
+		{
+			tree->links += entry.name;
+		}
+	}
+
+	/// @brief File copies or removals that are shared between threads.
+	struct FileJobs
+	{
+		Array<String> sources;
+		/// @brief Files are removed if there are no destinations.
+		Array<String> destinations;
+		/// @brief Guards next.
+		Mutex mutex;
+		int next;
+
+		FileJobs() : next(0)
+		{
+		}
+
+	};
+
+	static void _run_file_jobs(void* argument)
+	{
+		FileJobs* jobs = (FileJobs*)argument;
+		int index = 0;
+		while (true)
+		{
+			jobs->mutex.lock();
+			index = jobs->next;
+			++jobs->next;
+			jobs->mutex.unlock();
+			if (index >= jobs->sources.size())
+			{
+				break;
+			}
+			if (jobs->destinations.size() > 0)
+			{
+				File::copy(jobs->sources[index], jobs->destinations[index]);
+			}
+			else
+			{
+				File::remove(jobs->sources[index]);
+			}
+		}
+	}
+
+	static void _execute_file_jobs(FileJobs& jobs)
+	{
+		ThreadPool* pool = Parallel::getThreadPool();
+		Array<Task*> tasks;
+		if (pool != NULL)
+		{
+			// the calling thread works on the jobs as well
+			int count = hmin(pool->getWorkerCount(), jobs.sources.size() - 1);
+			for_iter (i, 0, count)
+			{
+				tasks += pool->submit(&_run_file_jobs, &jobs);
+			}
+		}
+		_run_file_jobs(&jobs);
+		// when called from a worker of the pool, waiting executes queued tasks instead of blocking the worker
+		foreach (Task*, it, tasks)
+		{
+			(*it)->wait();
+			delete (*it);
+		}
+	}
+
+	static bool _clear_parallel(const String& name)
+	{
+		DirTree tree(false);
+		Dir::walk(name, &_add_tree_entry, &tree);
+		FileJobs jobs;
+		foreach (String, it, tree.files)
+		{
+			jobs.sources += Dir::join_path(name, (*it), false);
+		}
+		_execute_file_jobs(jobs);
+		foreach (String, it, tree.links)
+		{
+#ifdef _WIN32
+			hrmdir(Dir::join_path(name, (*it), false));
+#else
+			File::remove(Dir::join_path(name, (*it), false));
+#endif
+		}
+		// a directory is always reported before its contents
+		foreach_r (String, it, tree.directories)
+		{
+			hrmdir(Dir::join_path(name, (*it), false));
+		}
+		return (tree.directories.size() > 0 || tree.files.size() > 0 || tree.links.size() > 0);
+	}
+	
+	bool Dir::remove(const String& dirname, bool parallel)
 	{
 		String name = Dir::normalize(dirname);
 		if (name == "" || !Dir::exists(name))
 		{
 			return false;
 		}
+		if (parallel)
+		{
+			_clear_parallel(name);
+			hrmdir(name);
+			return Dir::exists(name);
+		}
 		Array<String> directories = Dir::directories(name);
 		foreach (String, it, directories)
 		{
@@ -190,41 +447,221 @@ namespace hltypes
 		return Dir::exists(name);
 	}
 	
-	bool Dir::exists(const String& dirname, bool case_sensitive)
+	/// @brief Entries of a directory by their lower case names.
+	struct CaseInsensitiveListing
 	{
-		String name = Dir::normalize(dirname);
-		bool result = false;
-		DIR* dir = _opendir(name);
-		if (dir != NULL)
+		/// @brief Modification time of the directory when it was listed.
+		unsigned long long stamp;
+		HashMap<String, String> directories;
+		HashMap<String, String> files;
+
+	};
+
+	// listings are only replaced as a whole so lookups don't have to list the directory again
+	static ReadWriteMutex caseInsensitiveMutex;
+	static HashMap<String, CaseInsensitiveListing> caseInsensitiveListings;
+	// counts invalidations so listings that became outdated while they were created are not cached
+	static unsigned int caseInsensitiveVersion = 0;
+
+	/// @brief Listing of a watched directory.
+	struct WatchedListing
+	{
+		/// @brief Whether size and modification time were read as well.
+		bool with_info;
+		Array<DirEntry> entries;
+
+	};
+
+	static ReadWriteMutex watchedMutex;
+	static HashMap<String, WatchedListing> watchedListings;
+	// counts invalidations so listings that became outdated while they were created are not cached
+	static unsigned int watchedVersion = 0;
+
+	static bool _get_stamp(const String& dirname, unsigned long long& stamp)
+	{
+#ifdef _WIN32
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		if (GetFileAttributesExW(dirname.w_str().c_str(), GetFileExInfoStandard, &data) == 0 || (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
 		{
-			_closedir(dir);
-			result = true;
+			return false;
 		}
-		if (!result && !case_sensitive)
+		stamp = ((unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+#else
+		struct stat stats;
+		if (stat(dirname.c_str(), &stats) != 0 || !S_ISDIR(stats.st_mode))
+		{
+			return false;
+		}
+		stamp = (unsigned long long)stats.st_mtime * 1000000000ULL;
+#if defined(__linux__)
+		stamp += stats.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+		stamp += stats.st_mtimespec.tv_nsec;
+#endif
+#endif
+		return true;
+	}
+
+	static bool _is_racy_stamp(unsigned long long stamp)
+	{
+		// file systems like FAT only store modification times with a granularity of 2 seconds, so changes within the same
+		// time window as the listing can't be noticed (the same "racy" rule as in git)
+#ifdef _WIN32
+		FILETIME time;
+		GetSystemTimeAsFileTime(&time);
+		unsigned long long now = ((unsigned long long)time.dwHighDateTime << 32) | time.dwLowDateTime;
+		return (stamp + 20000000ULL > now);
+#else
+		unsigned long long now = (unsigned long long)::time(NULL) * 1000000000ULL;
+		return (stamp + 2000000000ULL > now);
+#endif
+	}
+
+	static void _list_case_insensitive(const String& dirname, CaseInsensitiveListing& listing)
+	{
+		Array<DirEntry> entries = Dir::scan(dirname);
+		String lower;
+		foreach (DirEntry, it, entries)
+		{
+			lower = (*it).name.lower();
+			HashMap<String, String>& names = ((*it).type == DirEntry::DIRECTORY ? listing.directories : listing.files);
+			// the first entry wins just like with a linear search
+			if (!names.has_key(lower))
+			{
+				names[lower] = (*it).name;
+			}
+		}
+	}
+
+	void Dir::setCaseInsensitiveCache(bool value)
+	{
+		caseInsensitiveCache = value;
+		if (!value)
+		{
+			Dir::clear_case_insensitive_cache();
+		}
+	}
+
+	void Dir::_invalidate(const String& dirname)
+	{
+		watchedMutex.lock_write();
+		watchedListings.remove_key(dirname);
+		++watchedVersion;
+		watchedMutex.unlock_write();
+		caseInsensitiveMutex.lock_write();
+		caseInsensitiveListings.remove_key(dirname);
+		++caseInsensitiveVersion;
+		caseInsensitiveMutex.unlock_write();
+	}
+
+	void Dir::clear_case_insensitive_cache()
+	{
+		caseInsensitiveMutex.lock_write();
+		caseInsensitiveListings.clear();
+		caseInsensitiveMutex.unlock_write();
+	}
+
+	bool Dir::_exists(const String& name, bool directory)
+	{
+#ifdef _WIN32
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		return (GetFileAttributesExW(name.w_str().c_str(), GetFileExInfoStandard, &data) != 0 &&
+			((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) == directory);
+#else
+		struct stat stats;
+		return (stat(name.c_str(), &stats) == 0 && S_ISDIR(stats.st_mode) == directory);
+#endif
+	}
+
+	String Dir::_find_case_insensitive(const String& dirname, const String& basename, bool directory)
+	{
+		String lower = basename.lower();
+		if (!caseInsensitiveCache)
 		{
-			hstr basedir = Dir::basedir(name);
-			hstr basename = Dir::basename(name);
-			Array<String> directories = Dir::directories(basedir);
-			foreach (String, it, directories)
+			Array<DirEntry> entries = Dir::scan(dirname);
+			foreach (DirEntry, it, entries)
 			{
-				if ((*it).lower() == basename.lower())
+				if (((*it).type == DirEntry::DIRECTORY) == directory && (*it).name.lower() == lower)
 				{
-					name = Dir::join_path(basedir, (*it));
-					result = true;
-					break;
+					return Dir::join_path(dirname, (*it).name);
 				}
 			}
+			return "";
+		}
+		// listings of watched directories are dropped on changes so they don't have to be checked
+		bool watched = DirWatch::is_watched(dirname);
+		unsigned long long stamp = 0;
+		if (!watched && !_get_stamp(dirname, stamp))
+		{
+			return "";
+		}
+		String result;
+		caseInsensitiveMutex.lock_read();
+		HashMap<String, CaseInsensitiveListing>::iterator it = caseInsensitiveListings.find(dirname);
+		if (it != caseInsensitiveListings.end() && it->second.stamp == stamp)
+		{
+			HashMap<String, String>& names = (directory ? it->second.directories : it->second.files);
+			HashMap<String, String>::iterator found = names.find(lower);
+			if (found != names.end())
+			{
+				result = Dir::join_path(dirname, found->second);
+			}
+			caseInsensitiveMutex.unlock_read();
+			return result;
+		}
+		unsigned int version = caseInsensitiveVersion;
+		caseInsensitiveMutex.unlock_read();
+		// a listing of a directory that changed recently is not cached, because later changes might not change the stamp
+		bool racy = (!watched && _is_racy_stamp(stamp));
+		// the directory is listed outside of the lock, if another thread does the same, the last listing is kept
+		CaseInsensitiveListing listing;
+		listing.stamp = stamp;
+		_list_case_insensitive(dirname, listing);
+		HashMap<String, String>& names = (directory ? listing.directories : listing.files);
+		if (names.has_key(lower))
+		{
+			result = Dir::join_path(dirname, names[lower]);
+		}
+		if (watched)
+		{
+			DirWatch::update();
+		}
+		if (racy)
+		{
+			return result;
+		}
+		caseInsensitiveMutex.lock_write();
+		// a watched directory that changed while it was being listed must not be cached
+		if (!watched || version == caseInsensitiveVersion)
+		{
+			caseInsensitiveListings[dirname] = listing;
+		}
+		caseInsensitiveMutex.unlock_write();
+		return result;
+	}
+
+	bool Dir::exists(const String& dirname, bool case_sensitive)
+	{
+		String name = Dir::normalize(dirname);
+		bool result = Dir::_exists(name, true);
+		if (!result && !case_sensitive)
+		{
+			result = (Dir::_find_case_insensitive(Dir::basedir(name), Dir::basename(name), true) != "");
 		}
 		return result;
 	}
 	
-	bool Dir::clear(const String& dirname)
+	bool Dir::clear(const String& dirname, bool parallel)
 	{
 		String name = Dir::normalize(dirname);
 		if (name == "" || !Dir::exists(name))
 		{
 			return false;
 		}
+		if (parallel)
+		{
+			return _clear_parallel(name);
+		}
 		Array<String> directories = Dir::directories(name);
 		foreach (String, it, directories)
 		{
@@ -257,7 +694,7 @@ namespace hltypes
 		return Dir::rename(name, Dir::join_path(path_name, Dir::basename(name), false));
 	}
 	
-	bool Dir::copy(const String& old_dirname, const String& new_dirname)
+	bool Dir::copy(const String& old_dirname, const String& new_dirname, bool parallel)
 	{
 		String old_name = Dir::normalize(old_dirname);
 		String new_name = Dir::normalize(new_dirname);
@@ -266,6 +703,26 @@ namespace hltypes
 			return false;
 		}
 		Dir::create(new_name);
+		if (parallel)
+		{
+			DirTree tree(true);
+			DirWalkOptions options;
+			options.follow_links = true;
+			Dir::walk(old_name, &_add_tree_entry, &tree, options);
+			// parents are always reported before their subdirectories
+			foreach (String, it, tree.directories)
+			{
+				hmkdir(Dir::join_path(new_name, (*it), false));
+			}
+			FileJobs jobs;
+			foreach (String, it, tree.files)
+			{
+				jobs.sources += Dir::join_path(old_name, (*it), false);
+				jobs.destinations += Dir::join_path(new_name, (*it), false);
+			}
+			_execute_file_jobs(jobs);
+			return true;
+		}
 		Array<String> directories = Dir::directories(old_name);
 		foreach (String, it, directories)
 		{
@@ -285,27 +742,66 @@ namespace hltypes
 		return (name != "" && name != "." && Dir::create(name));
 	}
 	
-	Array<String> Dir::entries(const String& dirname, bool prepend_dir)
+	Array<DirEntry> Dir::scan(const String& dirname, bool with_info)
 	{
 		String name = Dir::normalize(dirname);
-		Array<String> result;
-		if (Dir::exists(name))
+		Array<DirEntry> result;
+		bool watched = DirWatch::is_watched(name);
+		unsigned int version = 0;
+		if (watched)
 		{
-			DIR* dir = _opendir(name);
-			struct dirent* entry;
-			while ((entry = _readdir(dir)))
+			watchedMutex.lock_read();
+			HashMap<String, WatchedListing>::iterator it = watchedListings.find(name);
+			if (it != watchedListings.end() && (it->second.with_info || !with_info))
 			{
-				result += String::from_unicode(entry->d_name);
+				result = it->second.entries;
+				watchedMutex.unlock_read();
+				return result;
 			}
-			if (!result.contains("."))
+			version = watchedVersion;
+			watchedMutex.unlock_read();
+		}
+		DIR* dir = _opendir(name);
+		if (dir != NULL)
+		{
+			struct dirent* entry;
+			DirEntry current;
+			while ((entry = _readdir(dir)))
 			{
-				result += ".";
+				current.name = String::from_unicode(entry->d_name);
+				if (current.name != "." && current.name != "..")
+				{
+					_read_entry(dir, name, entry, current, with_info);
+					result += current;
+				}
 			}
-			if (!result.contains(".."))
+			_closedir(dir);
+			if (watched)
 			{
-				result += "..";
+				DirWatch::update();
+				watchedMutex.lock_write();
+				// a directory that changed while it was being read must not be cached
+				if (version == watchedVersion)
+				{
+					WatchedListing& listing = watchedListings[name];
+					listing.with_info = with_info;
+					listing.entries = result;
+				}
+				watchedMutex.unlock_write();
 			}
-			_closedir(dir);
+		}
+		return result;
+	}
+	
+	Array<String> Dir::entries(const String& dirname, bool prepend_dir)
+	{
+		String name = Dir::normalize(dirname);
+		Array<String> result;
+		if (Dir::exists(name))
+		{
+			result = Dir::contents(name);
+			result += String(".");
+			result += String("..");
 		}
 		if (prepend_dir)
 		{
@@ -317,24 +813,12 @@ namespace hltypes
 	Array<String> Dir::contents(const String& dirname, bool prepend_dir)
 	{
 		String name = Dir::normalize(dirname);
+		Array<DirEntry> entries = Dir::scan(name);
 		Array<String> result;
-		if (Dir::exists(name))
+		result.reserve(entries.size());
+		foreach (DirEntry, it, entries)
 		{
-			DIR* dir = _opendir(name);
-			struct dirent* entry;
-			while ((entry = _readdir(dir)))
-			{
-				result += String::from_unicode(entry->d_name);
-			}
-			if (result.contains("."))
-			{
-				result.remove(".");
-			}
-			if (result.contains(".."))
-			{
-				result.remove("..");
-			}
-			_closedir(dir);
+			result += (*it).name;
 		}
 		if (prepend_dir)
 		{
@@ -346,29 +830,14 @@ namespace hltypes
 	Array<String> Dir::directories(const String& dirname, bool prepend_dir)
 	{
 		String name = Dir::normalize(dirname);
-		String current;
+		Array<DirEntry> entries = Dir::scan(name);
 		Array<String> result;
-		if (Dir::exists(name))
+		foreach (DirEntry, it, entries)
 		{
-			DIR* dir = _opendir(name);
-			struct dirent* entry;
-			while ((entry = _readdir(dir)))
-			{
-				current = Dir::join_path(name, String::from_unicode(entry->d_name), false);
-				if (Dir::exists(current))
-				{
-					result += String::from_unicode(entry->d_name);
-				}
-			}
-			if (result.contains("."))
+			if ((*it).type == DirEntry::DIRECTORY)
 			{
-				result.remove(".");
+				result += (*it).name;
 			}
-			if (result.contains(".."))
-			{
-				result.remove("..");
-			}
-			_closedir(dir);
 		}
 		if (prepend_dir)
 		{
@@ -380,35 +849,283 @@ namespace hltypes
 	Array<String> Dir::files(const String& dirname, bool prepend_dir)
 	{
 		String name = Dir::normalize(dirname);
-		String current;
+		Array<DirEntry> entries = Dir::scan(name);
 		Array<String> result;
-		if (Dir::exists(name))
+		foreach (DirEntry, it, entries)
+		{
+			if ((*it).type == DirEntry::REGULAR_FILE)
+			{
+				result += (*it).name;
+			}
+		}
+		if (prepend_dir)
+		{
+			Dir::_prepend_directory(name, result);
+		}
+		return result;
+	}
+
+	/// @brief Shared state of a directory walk.
+	struct WalkState
+	{
+		const DirWalkOptions* options;
+		void (*callback)(const DirEntry& entry, void* argument);
+		void* argument;
+		/// @brief Guards entries and delivering.
+		Mutex callbackMutex;
+		/// @brief Entries that still have to be passed to the callback in parallel walks.
+		Deque<DirEntry> entries;
+		/// @brief Whether a thread is currently passing entries to the callback.
+		bool delivering;
+		ThreadPool* pool;
+		/// @brief Maximum number of queued subdirectories, more subdirectories are walked directly.
+		int maxPending;
+		/// @brief Guards pending and tasks.
+		Mutex mutex;
+		int pending;
+		Array<Task*> tasks;
+
+		WalkState() : options(NULL), callback(NULL), argument(NULL), delivering(false), pool(NULL), maxPending(0), pending(0)
+		{
+		}
+
+	};
+
+	/// @brief Identifies a directory for detecting cycles through symbolic links.
+	typedef std::pair<unsigned long long, unsigned long long> WalkNode;
+
+	// the thread that currently calls the callback delivers entries of other threads as well so no thread ever blocks on the callback,
+	// otherwise a callback that waits for work on the ThreadPool could execute a walk task that waits for the callback
+	static void _deliver_walk_entry(WalkState* state, const DirEntry& entry)
+	{
+		state->callbackMutex.lock();
+		state->entries.push_back(entry);
+		if (state->delivering)
+		{
+			state->callbackMutex.unlock();
+			return;
+		}
+		state->delivering = true;
+		DirEntry current;
+		while (state->entries.size() > 0)
+		{
+			current = state->entries.pop_front();
+			state->callbackMutex.unlock();
+			state->callback(current, state->argument);
+			state->callbackMutex.lock();
+		}
+		state->delivering = false;
+		state->callbackMutex.unlock();
+	}
+
+	static bool _walk_entry(WalkState* state, DirEntry& current, int depth)
+	{
+		if (state->options->filter != NULL && !state->options->filter(current))
+		{
+			return false;
+		}
+		if (state->pool != NULL)
+		{
+			_deliver_walk_entry(state, current);
+		}
+		else
+		{
+			state->callback(current, state->argument);
+		}
+		return (current.type == DirEntry::DIRECTORY && (state->options->max_depth < 0 || depth < state->options->max_depth) &&
+			(state->options->follow_links || !current.link));
+	}
+
+	static bool _submit_walk(WalkState* state, const String& path, const String& prefix, int depth, const std::vector<WalkNode>& ancestors);
+
+#if !defined(_WIN32) && defined(AT_FDCWD)
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+#ifndef O_DIRECTORY
+#define O_DIRECTORY 0
+#endif
+	// directories are opened relative to their parent so the kernel doesn't have to resolve the whole path every time
+	static void _walk_directory(WalkState* state, int fd, const String& path, const String& prefix, int depth, std::vector<WalkNode>& ancestors)
+	{
+		struct stat stats;
+		if (state->options->follow_links)
+		{
+			if (fstat(fd, &stats) != 0)
+			{
+				close(fd);
+				return;
+			}
+			WalkNode node((unsigned long long)stats.st_dev, (unsigned long long)stats.st_ino);
+			if (std::find(ancestors.begin(), ancestors.end(), node) != ancestors.end())
+			{
+				close(fd);
+				return;
+			}
+			ancestors.push_back(node);
+		}
+		DIR* dir = fdopendir(fd);
+		if (dir == NULL)
+		{
+			close(fd);
+		}
+		else
 		{
-			DIR* dir = _opendir(name);
 			struct dirent* entry;
-			while ((entry = _readdir(dir)))
+			DirEntry current;
+			String name;
+			int child = 0;
+			int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (state->options->follow_links ? 0 : O_NOFOLLOW);
+			while ((entry = readdir(dir)))
 			{
-				current = Dir::join_path(name, String::from_unicode(entry->d_name), false);
-				if (File::exists(current))
+				name = entry->d_name;
+				if (name == "." || name == "..")
 				{
-					result += String::from_unicode(entry->d_name);
+					continue;
+				}
+				_read_entry(dir, path, entry, current, state->options->with_info);
+				current.name = (prefix != "" ? prefix + "/" + name : name);
+				if (_walk_entry(state, current, depth) && !_submit_walk(state, Dir::join_path(path, name, false), current.name, depth + 1, ancestors))
+				{
+					child = openat(dirfd(dir), entry->d_name, flags);
+					if (child >= 0)
+					{
+						_walk_directory(state, child, Dir::join_path(path, name, false), current.name, depth + 1, ancestors);
+					}
 				}
 			}
-			if (result.contains("."))
+			closedir(dir);
+		}
+		if (state->options->follow_links)
+		{
+			ancestors.pop_back();
+		}
+	}
+
+	static void _walk(WalkState* state, const String& path, const String& prefix, int depth, std::vector<WalkNode>& ancestors)
+	{
+		int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (fd >= 0)
+		{
+			_walk_directory(state, fd, path, prefix, depth, ancestors);
+		}
+	}
+#else
+	// without openat every directory is scanned by its path, cycles through links end once paths get too long
+	static void _walk(WalkState* state, const String& path, const String& prefix, int depth, std::vector<WalkNode>& ancestors)
+	{
+		Array<DirEntry> entries = Dir::scan(path, state->options->with_info);
+		String name;
+		foreach (DirEntry, it, entries)
+		{
+			name = (*it).name;
+			(*it).name = (prefix != "" ? prefix + "/" + name : name);
+			if (_walk_entry(state, (*it), depth) && !_submit_walk(state, Dir::join_path(path, name, false), (*it).name, depth + 1, ancestors))
 			{
-				result.remove(".");
+				_walk(state, Dir::join_path(path, name, false), (*it).name, depth + 1, ancestors);
 			}
-			if (result.contains(".."))
+		}
+	}
+#endif
+
+	/// @brief Walks a subdirectory on a ThreadPool.
+	class WalkTask : public Task
+	{
+	public:
+		WalkTask(WalkState* state, const String& path, const String& prefix, int depth, const std::vector<WalkNode>& ancestors) :
+			Task(), state(state), path(path), prefix(prefix), depth(depth), ancestors(ancestors)
+		{
+		}
+
+		void execute()
+		{
+			_walk(this->state, this->path, this->prefix, this->depth, this->ancestors);
+			this->state->mutex.lock();
+			--this->state->pending;
+			this->state->mutex.unlock();
+		}
+
+	protected:
+		WalkState* state;
+		String path;
+		String prefix;
+		int depth;
+		std::vector<WalkNode> ancestors;
+
+	};
+
+	static bool _submit_walk(WalkState* state, const String& path, const String& prefix, int depth, const std::vector<WalkNode>& ancestors)
+	{
+		if (state->pool == NULL)
+		{
+			return false;
+		}
+		state->mutex.lock();
+		// subdirectories are walked directly once enough work is queued
+		if (state->pending >= state->maxPending)
+		{
+			state->mutex.unlock();
+			return false;
+		}
+		++state->pending;
+		WalkTask* task = new WalkTask(state, path, prefix, depth, ancestors);
+		state->tasks += task;
+		state->mutex.unlock();
+		state->pool->submit(task);
+		return true;
+	}
+
+	static void _add_walk_entry(const DirEntry& entry, void* argument)
+	{
+		((Array<DirEntry>*)argument)->push_back(entry);
+	}
+
+	Array<DirEntry> Dir::walk(const String& dirname, const DirWalkOptions& options)
+	{
+		Array<DirEntry> result;
+		Dir::walk(dirname, &_add_walk_entry, &result, options);
+		return result;
+	}
+
+	void Dir::walk(const String& dirname, void (*callback)(const DirEntry& entry, void* argument), void* argument, const DirWalkOptions& options)
+	{
+		WalkState state;
+		state.options = &options;
+		state.callback = callback;
+		state.argument = argument;
+		if (options.parallel)
+		{
+			state.pool = Parallel::getThreadPool();
+			if (state.pool != NULL)
 			{
-				result.remove("..");
+				state.maxPending = state.pool->getWorkerCount() * 4;
 			}
-			_closedir(dir);
 		}
-		if (prepend_dir)
+		std::vector<WalkNode> ancestors;
+		_walk(&state, Dir::normalize(dirname), "", 0, ancestors);
+		if (state.pool != NULL)
 		{
-			Dir::_prepend_directory(name, result);
+			// tasks add their subtasks before they are done so all tasks are done once the last listed task is done, waiting on the
+			// tasks instead of a counter lets a worker of the pool execute queued tasks while it waits
+			Task* task = NULL;
+			int index = 0;
+			while (true)
+			{
+				state.mutex.lock();
+				task = (index < state.tasks.size() ? state.tasks[index] : NULL);
+				state.mutex.unlock();
+				if (task == NULL)
+				{
+					break;
+				}
+				task->wait();
+				++index;
+			}
+			foreach (Task*, it, state.tasks)
+			{
+				delete (*it);
+			}
 		}
-		return result;
 	}
 
 	void Dir::chdir(const String& dirname)
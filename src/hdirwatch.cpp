@@ -0,0 +1,402 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+
+#ifdef __linux__
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define _HL_INOTIFY
+#endif
+
+#include "harray.h"
+#include "hdir.h"
+#include "hdirwatch.h"
+#include "hhashmap.h"
+#include "hmutex.h"
+#include "hstring.h"
+
+#ifdef _HL_INOTIFY
+// changes that affect the listing of a directory or the information about its entries
+#define WATCH_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+#define EVENT_BUFFER_SIZE 4096
+#endif
+
+namespace hltypes
+{
+	/// @brief A watched directory.
+	struct WatchedDirectory
+	{
+		/// @brief Watch descriptor of inotify.
+		int descriptor;
+		/// @brief Whether subdirectories are watched as well.
+		bool recursive;
+
+	};
+
+	/// @brief A function that is called for changed directories.
+	struct WatchCallback
+	{
+		void (*function)(const String& dirname, void* argument);
+		void* argument;
+
+		bool operator==(const WatchCallback& other) const
+		{
+			return (this->function == other.function && this->argument == other.argument);
+		}
+
+	};
+
+	// guards everything except the callbacks
+	static Mutex mutex("hltypes::DirWatch::mutex");
+	// guards the callbacks, the changed directories that still have to be passed to them and the delivering flag
+	static Mutex callbackMutex("hltypes::DirWatch::callbackMutex");
+	static Array<WatchCallback> callbacks;
+#ifdef _HL_INOTIFY
+	static Array<String> pendingChanges;
+	static bool delivering = false;
+	static int notifyDescriptor = -1;
+	static HashMap<String, WatchedDirectory> directories;
+	// the same directory can be watched under different names
+	static HashMap<int, Array<String> > names;
+
+	static bool _add(const String& name, bool recursive)
+	{
+		if (notifyDescriptor < 0)
+		{
+			notifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (notifyDescriptor < 0)
+			{
+				return false;
+			}
+		}
+		int descriptor = inotify_add_watch(notifyDescriptor, name.c_str(), WATCH_EVENTS);
+		if (descriptor < 0)
+		{
+			return false;
+		}
+		if (directories.has_key(name))
+		{
+			WatchedDirectory& directory = directories[name];
+			directory.recursive |= recursive;
+			if (directory.descriptor == descriptor)
+			{
+				return true;
+			}
+			// the path leads to a different directory now, e.g. after the old one was renamed and a new one was created
+			Array<String>& descriptorNames = names[directory.descriptor];
+			descriptorNames.remove_all(name);
+			if (descriptorNames.size() == 0)
+			{
+				names.remove_key(directory.descriptor);
+				inotify_rm_watch(notifyDescriptor, directory.descriptor);
+			}
+			directory.descriptor = descriptor;
+			if (!names[descriptor].contains(name))
+			{
+				names[descriptor] += name;
+			}
+			return true;
+		}
+		WatchedDirectory& directory = directories[name];
+		directory.descriptor = descriptor;
+		directory.recursive = recursive;
+		names[descriptor] += name;
+		return true;
+	}
+
+	static void _add_subdirectories(const String& name)
+	{
+		Array<DirEntry> entries = Dir::walk(name);
+		foreach (DirEntry, it, entries)
+		{
+			if ((*it).type == DirEntry::DIRECTORY && !(*it).link)
+			{
+				_add(Dir::join_path(name, (*it).name, false), true);
+			}
+		}
+	}
+
+	static void _remove(const String& name, bool watched)
+	{
+		int descriptor = directories[name].descriptor;
+		directories.remove_key(name);
+		Array<String>& descriptorNames = names[descriptor];
+		descriptorNames.remove_all(name);
+		if (descriptorNames.size() == 0)
+		{
+			names.remove_key(descriptor);
+			if (watched)
+			{
+				inotify_rm_watch(notifyDescriptor, descriptor);
+			}
+		}
+	}
+
+	static void _remove_path(const String& name, Array<String>& removed)
+	{
+		String prefix = name + "/";
+		Array<String> paths;
+		foreach_hm (WatchedDirectory, it, directories)
+		{
+			if (it->first == name || it->first.starts_with(prefix))
+			{
+				paths += it->first;
+			}
+		}
+		foreach (String, it, paths)
+		{
+			_remove((*it), true);
+		}
+		removed += paths;
+	}
+
+	// callbacks are called without holding a lock so they can use DirWatch and cached Dir operations themselves, the thread that is
+	// currently calling them takes over the changes of other threads so they are still never called from multiple threads at once
+	static void _notify(const Array<String>& changed)
+	{
+		callbackMutex.lock();
+		pendingChanges += changed;
+		if (delivering)
+		{
+			callbackMutex.unlock();
+			return;
+		}
+		delivering = true;
+		Array<String> dirnames;
+		Array<WatchCallback> currentCallbacks;
+		while (pendingChanges.size() > 0)
+		{
+			dirnames.swap(pendingChanges);
+			currentCallbacks = callbacks;
+			callbackMutex.unlock();
+			foreach (WatchCallback, it, currentCallbacks)
+			{
+				foreach (String, it2, dirnames)
+				{
+					(*it).function((*it2), (*it).argument);
+				}
+			}
+			dirnames.clear();
+			callbackMutex.lock();
+		}
+		delivering = false;
+		callbackMutex.unlock();
+	}
+#endif
+
+	bool DirWatch::is_supported()
+	{
+#ifdef _HL_INOTIFY
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool DirWatch::add(const String& dirname, bool recursive)
+	{
+#ifdef _HL_INOTIFY
+		String name = Dir::normalize(dirname);
+		ScopeLock lock(&mutex);
+		if (!_add(name, recursive))
+		{
+			return false;
+		}
+		// added after the directory itself so subdirectories that are created in the meantime aren't missed
+		if (recursive)
+		{
+			_add_subdirectories(name);
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool DirWatch::remove(const String& dirname)
+	{
+#ifdef _HL_INOTIFY
+		String name = Dir::normalize(dirname);
+		ScopeLock lock(&mutex);
+		if (!directories.has_key(name))
+		{
+			return false;
+		}
+		Array<String> removed;
+		removed += name;
+		if (directories[name].recursive)
+		{
+			String prefix = name + "/";
+			foreach_hm (WatchedDirectory, it, directories)
+			{
+				if (it->second.recursive && it->first.starts_with(prefix))
+				{
+					removed += it->first;
+				}
+			}
+		}
+		foreach (String, it, removed)
+		{
+			_remove((*it), true);
+			// changes are not tracked anymore so cached listings can't be trusted either
+			Dir::_invalidate(*it);
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void DirWatch::clear()
+	{
+#ifdef _HL_INOTIFY
+		ScopeLock lock(&mutex);
+		Array<String> removed = directories.keys();
+		if (notifyDescriptor >= 0)
+		{
+			close(notifyDescriptor); // removes all watches as well
+			notifyDescriptor = -1;
+		}
+		directories.clear();
+		names.clear();
+		foreach (String, it, removed)
+		{
+			Dir::_invalidate(*it);
+		}
+#endif
+	}
+
+	bool DirWatch::is_watched(const String& dirname)
+	{
+#ifdef _HL_INOTIFY
+		// pending changes can add or remove watched directories
+		DirWatch::update();
+		String name = Dir::normalize(dirname);
+		ScopeLock lock(&mutex);
+		return directories.has_key(name);
+#else
+		return false;
+#endif
+	}
+
+	void DirWatch::update()
+	{
+#ifdef _HL_INOTIFY
+		Array<String> changed;
+		mutex.lock();
+		if (notifyDescriptor < 0)
+		{
+			mutex.unlock();
+			return;
+		}
+		// aligned for inotify_event
+		unsigned long long buffer[EVENT_BUFFER_SIZE / sizeof(unsigned long long)];
+		char* data = (char*)buffer;
+		struct inotify_event* event = NULL;
+		Array<String> eventNames;
+		Array<String> created;
+		int count = 0;
+		while (true)
+		{
+			count = (int)read(notifyDescriptor, data, sizeof(buffer));
+			if (count < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (count <= 0)
+			{
+				break;
+			}
+			for (char* pointer = data; pointer < data + count; pointer += sizeof(struct inotify_event) + event->len)
+			{
+				event = (struct inotify_event*)pointer;
+				if ((event->mask & IN_Q_OVERFLOW) != 0)
+				{
+					// events were lost so nothing can be trusted anymore
+					changed += directories.keys();
+					continue;
+				}
+				if (!names.has_key(event->wd))
+				{
+					continue;
+				}
+				eventNames = names[event->wd];
+				changed += eventNames;
+				if ((event->mask & IN_ISDIR) != 0 && (event->mask & (IN_CREATE | IN_MOVED_TO)) != 0 && event->len > 0)
+				{
+					foreach (String, it, eventNames)
+					{
+						if (directories[*it].recursive)
+						{
+							created += Dir::join_path((*it), String(event->name), false);
+						}
+					}
+				}
+				if ((event->mask & IN_ISDIR) != 0 && (event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0 && event->len > 0)
+				{
+					// paths in the old location must not stay attached to the watches of the moved directories
+					foreach (String, it, eventNames)
+					{
+						_remove_path(Dir::join_path((*it), String(event->name), false), changed);
+					}
+				}
+				if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) != 0)
+				{
+					// the given path doesn't lead to the watched directory anymore
+					foreach (String, it, eventNames)
+					{
+						if (directories.has_key(*it))
+						{
+							_remove((*it), (event->mask & IN_IGNORED) == 0);
+						}
+					}
+				}
+			}
+		}
+		foreach (String, it, created)
+		{
+			if (_add((*it), true))
+			{
+				_add_subdirectories(*it);
+			}
+		}
+		changed.remove_duplicates();
+		// invalidated while still locked so no other thread can use a cached listing of a changed directory
+		foreach (String, it, changed)
+		{
+			Dir::_invalidate(*it);
+		}
+		mutex.unlock();
+		if (changed.size() > 0)
+		{
+			_notify(changed);
+		}
+#endif
+	}
+
+	void DirWatch::subscribe(void (*callback)(const String& dirname, void* argument), void* argument)
+	{
+		WatchCallback watchCallback;
+		watchCallback.function = callback;
+		watchCallback.argument = argument;
+		ScopeLock lock(&callbackMutex);
+		callbacks += watchCallback;
+	}
+
+	void DirWatch::unsubscribe(void (*callback)(const String& dirname, void* argument), void* argument)
+	{
+		WatchCallback watchCallback;
+		watchCallback.function = callback;
+		watchCallback.argument = argument;
+		ScopeLock lock(&callbackMutex);
+		callbacks.remove_all(watchCallback);
+	}
+
+}
+
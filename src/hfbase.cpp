@@ -7,13 +7,19 @@
 /// This program is free software; you can redistribute it and/or modify it under
 /// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
 
+#include <string.h>
 #ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 #endif
 
+#include "exception.h"
 #include "hdir.h"
 #include "hfbase.h"
+#include "hltypesUtil.h"
 #include "hstring.h"
 #include "hthread.h"
 
@@ -34,12 +40,12 @@ namespace hltypes
 	{
 	}
 
-	FileBase::FileBase(const String& filename, unsigned char encryption_offset) : StreamBase(encryption_offset), cfile(NULL)
+	FileBase::FileBase(const String& filename, unsigned char encryption_offset) : StreamBase(encryption_offset), cfile(NULL), mapped(false), mapped_data(NULL), mapped_size(0), mapped_position(0)
 	{
 		this->filename = Dir::normalize(filename);
 	}
 	
-	FileBase::FileBase(unsigned char encryption_offset) : StreamBase(encryption_offset), cfile(NULL)
+	FileBase::FileBase(unsigned char encryption_offset) : StreamBase(encryption_offset), cfile(NULL), mapped(false), mapped_data(NULL), mapped_size(0), mapped_position(0)
 	{
 	}
 	
@@ -95,6 +101,7 @@ namespace hltypes
 		switch (access_mode)
 		{
 		case READ:
+		case READ_MAPPED:
 			mode = "rb";
 			break;
 		case WRITE:
@@ -116,6 +123,16 @@ namespace hltypes
 		int attempts = repeats + 1;
 		while (true)
 		{
+#ifndef _WIN32
+			if (access_mode == READ_MAPPED)
+			{
+				if (this->_fmap())
+				{
+					break;
+				}
+			}
+			else
+#endif
 #ifdef _WIN32
 			this->cfile = _wfopen(this->filename.w_str().c_str(), mode.w_str().c_str());
 #else
@@ -132,43 +149,150 @@ namespace hltypes
 			}
 			Thread::sleep(timeout);
 		}
-		if (this->cfile == NULL)
+		if (!this->_fis_open())
 		{
 			throw file_not_found(this->_descriptor());
 		}
-		this->_update_data_size();
+		this->_fupdate_data_size();
+	}
+	
+	bool FileBase::_fmap()
+	{
+#ifndef _WIN32
+		int fd = ::open(this->filename.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+		struct stat stats;
+		if (fstat(fd, &stats) != 0 || (stats.st_mode & S_IFMT) == S_IFDIR)
+		{
+			::close(fd);
+			return false;
+		}
+		void* data = NULL;
+		if (stats.st_size > 0)
+		{
+			data = mmap(NULL, (size_t)stats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED)
+			{
+				::close(fd);
+				return false;
+			}
+		}
+		// the mapping stays valid after the descriptor has been closed
+		::close(fd);
+		this->mapped = true;
+		this->mapped_data = (unsigned char*)data;
+		this->mapped_size = (long)stats.st_size;
+		this->mapped_position = 0;
+		return true;
+#else
+		return false;
+#endif
 	}
 	
 	void FileBase::_fclose()
 	{
 		this->_check_availability();
-		fclose((FILE*)this->cfile);
-		this->cfile = NULL;
+		if (this->mapped)
+		{
+#ifndef _WIN32
+			if (this->mapped_data != NULL)
+			{
+				munmap(this->mapped_data, (size_t)this->mapped_size);
+			}
+#endif
+			this->mapped = false;
+			this->mapped_data = NULL;
+			this->mapped_size = 0;
+			this->mapped_position = 0;
+		}
+		else
+		{
+			fclose((FILE*)this->cfile);
+			this->cfile = NULL;
+		}
 		this->data_size = 0;
 	}
 	
 	long FileBase::_fread(void* buffer, int size, int count)
 	{
-		return fread(buffer, size, count, (FILE*)this->cfile);
+		if (!this->mapped)
+		{
+			return fread(buffer, size, count, (FILE*)this->cfile);
+		}
+		if (size <= 0 || count <= 0)
+		{
+			return 0;
+		}
+		long read_count = hmin((long)count, (this->mapped_size - this->mapped_position) / size);
+		if (read_count > 0)
+		{
+			memcpy(buffer, &this->mapped_data[this->mapped_position], read_count * size);
+			this->mapped_position += read_count * size;
+		}
+		return read_count;
 	}
 	
 	long FileBase::_fwrite(const void* buffer, int size, int count)
 	{
-		return fwrite(buffer, size, count, (FILE*)this->cfile);
+		if (this->mapped)
+		{
+			throw file_not_writeable(this->_descriptor());
+		}
+		long result = fwrite(buffer, size, count, (FILE*)this->cfile);
+		// ftell() doesn't flush the write buffer like fseek() does so this is a cheap way to track the size
+		this->data_size = hmax(this->data_size, (long)ftell((FILE*)this->cfile));
+		return result;
+	}
+	
+	void FileBase::_fupdate_data_size()
+	{
+		if (this->mapped)
+		{
+			this->data_size = this->mapped_size;
+			return;
+		}
+		long position = this->_fposition();
+		this->_fseek(0, END);
+		this->data_size = this->_fposition();
+		this->_fseek(position, START);
 	}
 	
 	bool FileBase::_fis_open()
 	{
-		return (this->cfile != NULL);
+		return (this->cfile != NULL || this->mapped);
 	}
 	
 	long FileBase::_fposition()
 	{
+		if (this->mapped)
+		{
+			return this->mapped_position;
+		}
 		return ftell((FILE*)this->cfile);
 	}
 	
 	void FileBase::_fseek(long offset, SeekMode seek_mode)
 	{
+		if (this->mapped)
+		{
+			long target = offset;
+			switch (seek_mode)
+			{
+			case CURRENT:
+				target += this->mapped_position;
+				break;
+			case START:
+				break;
+			case END:
+				target += this->mapped_size;
+				break;
+			}
+			this->mapped_position = hclamp(target, 0L, this->mapped_size);
+			return;
+		}
 		int mode = SEEK_CUR;
 		switch (seek_mode)
 		{
@@ -188,44 +312,12 @@ namespace hltypes
 	bool FileBase::_fexists(const String& filename, bool case_sensitive)
 	{
 		String name = Dir::normalize(filename);
-		bool result = false;
-#ifdef _WIN32
-		FILE* f = _wfopen(name.w_str().c_str(), L"rb");
-#else
-		FILE* f = fopen(name.c_str(), "rb"); // TODO - should be ported to Unix systems as well
-#endif
-		if (f != NULL)
-		{
-			fclose(f);
-			result = true;
-		}
+		// a single stat is much cheaper than opening the file and it rules out directories at the same time
+		bool result = Dir::_exists(name, false);
 		if (!result && !case_sensitive)
 		{
-			hstr basedir = Dir::basedir(name);
-			hstr basename = Dir::basename(name);
-			Array<String> files = Dir::files(basedir);
-			foreach (String, it, files)
-			{
-				if ((*it).lower() == basename.lower())
-				{
-					name = Dir::join_path(basedir, (*it));
-					result = true;
-					break;
-				}
-			}
-		}
-#ifndef _WIN32
-		if (result)
-		{
-			struct stat stats;
-			// on UNIX fopen on a directory actually works so this check prevents
-			// errorously reporting the existence of a file if it's a directory
-			if (stat(name.c_str(), &stats) == 0 && (stats.st_mode & S_IFMT) == S_IFDIR)
-			{
-				result = false;
-			}
+			result = (Dir::_find_case_insensitive(Dir::basedir(name), Dir::basename(name), false) != "");
 		}
-#endif
 		return result;
 	}
 	
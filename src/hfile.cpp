@@ -18,14 +18,31 @@ int (*f_remove)(const char* filename) = remove;
 #include "exception.h"
 #include "hdir.h"
 #include "hfile.h"
+#include "hplatform.h"
 #include "hstring.h"
 #include "hthread.h"
 
 #if !defined _WIN32 && !defined(_WINRT)
+#include <errno.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC__ == 2 && __GLIBC_MINOR__ >= 27)
+#define _HL_COPY_FILE_RANGE
+#endif
+#endif
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
 #endif
 
 #define BUFFER_SIZE 4096
+#define COPY_BUFFER_SIZE 65536
+#define COPY_CHUNK_SIZE 0x40000000
 
 namespace hltypes
 {
@@ -56,6 +73,12 @@ namespace hltypes
 		this->_fclose();
 	}
 	
+	void File::refresh_size()
+	{
+		this->_check_availability();
+		this->_fupdate_data_size();
+	}
+	
 	long File::_read(void* buffer, int size, int count)
 	{
 		return this->_fread(buffer, size, count);
@@ -81,6 +104,20 @@ namespace hltypes
 		this->_fseek(offset, seek_mode);
 	}
 	
+	void File::_update_data_size()
+	{
+	}
+	
+	const unsigned char* File::_direct_data(long& size)
+	{
+		if (!this->mapped || this->mapped_data == NULL)
+		{
+			return NULL;
+		}
+		size = this->mapped_size - this->mapped_position;
+		return &this->mapped_data[this->mapped_position];
+	}
+	
 	bool File::create(const String& filename)
 	{
 		String name = Dir::normalize(filename);
@@ -172,6 +209,80 @@ namespace hltypes
 		return File::rename(name, Dir::join_path(path, Dir::basename(name), false), overwrite);
 	}
 	
+#if !defined(_WIN32)
+	// tries the fastest way first and falls back to the next one if the kernel or the file system doesn't support it
+	static bool _copy_data(int source, int destination, off_t size)
+	{
+#ifdef FICLONE
+		// a reflink shares the data blocks on copy-on-write file systems so nothing has to be copied at all
+		if (ioctl(destination, FICLONE, source) == 0)
+		{
+			return true;
+		}
+#endif
+#ifdef FALLOC_FL_KEEP_SIZE
+		if (size > 0)
+		{
+			fallocate(destination, FALLOC_FL_KEEP_SIZE, 0, size); // only a hint, the copy works without it as well
+		}
+#endif
+		ssize_t count = 0;
+#ifdef _HL_COPY_FILE_RANGE
+		// copies within the kernel, some file systems can even do it without moving the data
+		off_t copied = 0;
+		while ((count = copy_file_range(source, NULL, destination, NULL, COPY_CHUNK_SIZE, 0)) > 0)
+		{
+			copied += count;
+		}
+		if (count == 0)
+		{
+			return true;
+		}
+		if (copied > 0)
+		{
+			return false;
+		}
+#endif
+#ifdef __linux__
+		off_t sent = 0;
+		while ((count = sendfile(destination, source, NULL, COPY_CHUNK_SIZE)) > 0)
+		{
+			sent += count;
+		}
+		if (count == 0)
+		{
+			return true;
+		}
+		if (sent > 0)
+		{
+			return false;
+		}
+#endif
+		unsigned char* buffer = new unsigned char[COPY_BUFFER_SIZE];
+		bool result = true;
+		ssize_t written = 0;
+		while (result && (count = read(source, buffer, COPY_BUFFER_SIZE)) != 0)
+		{
+			if (count < 0)
+			{
+				result = (errno == EINTR);
+				continue;
+			}
+			for (ssize_t i = 0; result && i < count; i += written)
+			{
+				written = write(destination, &buffer[i], count - i);
+				if (written < 0)
+				{
+					result = (errno == EINTR);
+					written = 0;
+				}
+			}
+		}
+		delete [] buffer;
+		return result;
+	}
+#endif
+
 	bool File::copy(const String& old_filename, const String& new_filename, bool overwrite)
 	{
 		String old_name = Dir::normalize(old_filename);
@@ -181,6 +292,30 @@ namespace hltypes
 			return false;
 		}
 		Dir::create(Dir::basedir(new_name));
+#if defined(_WIN32) && !defined(_WINRT)
+		return (CopyFileW(old_name.w_str().c_str(), new_name.w_str().c_str(), FALSE) != 0);
+#elif !defined(_WIN32)
+		int source = ::open(old_name.c_str(), O_RDONLY | O_CLOEXEC);
+		if (source < 0)
+		{
+			return false;
+		}
+		struct stat stats;
+		if (fstat(source, &stats) != 0)
+		{
+			::close(source);
+			return false;
+		}
+		int destination = ::open(new_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, stats.st_mode & 0777);
+		if (destination < 0)
+		{
+			::close(source);
+			return false;
+		}
+		bool result = _copy_data(source, destination, stats.st_size);
+		::close(source);
+		return (::close(destination) == 0 && result);
+#else
 		File old_file(old_name);
 		File new_file(new_name, File::WRITE);
 		int count;
@@ -191,6 +326,7 @@ namespace hltypes
 			fwrite(c, 1, count, (FILE*)new_file.cfile);
 		}
 		return true;
+#endif
 	}
 	
 	long File::hsize(const String& filename)
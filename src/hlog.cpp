@@ -10,17 +10,22 @@
 #ifdef _ANDROID
 #include <android/log.h>
 #endif
+#include <algorithm>
 #include <stdarg.h>
 
 #include "harray.h"
+#include "hcondition.h"
 #include "hdir.h"
 #include "hfile.h"
 #include "hlog.h"
+#include "hltypesUtil.h"
 #include "hmutex.h"
 #include "hplatform.h"
 #include "hstring.h"
+#include "hthread.h"
 
 #define MAX_FILE_SIZE 131072
+#define ASYNC_IDLE_TIMEOUT 100.0f
 
 #if defined(_ANDROID) && !defined(_DEBUG)
 #define LEVEL_PLATFORM(level) ((level) == Log::LevelDebug ? Log::LevelWrite : (level))
@@ -39,7 +44,37 @@
 
 namespace hltypes
 {
-	static hmutex log_mutex;
+	static hmutex log_mutex("hltypes::log_mutex");
+	// guards the queue, the asynchronous logging flag and the dropped message count
+	static Condition queue_condition;
+	// kept open by the writer thread while messages keep coming, guarded by log_mutex
+	static hfile async_file;
+	static String async_filename;
+
+	/// @brief A queued message for asynchronous logging.
+	struct LogRecord
+	{
+		String tag;
+		String message;
+		int level;
+	};
+
+	static Array<LogRecord> log_queue;
+	// guards the messages that are waiting for the callback and the delivering flag
+	static Condition callback_condition;
+	static Array<LogRecord> callback_queue;
+	static bool delivering = false;
+	// set while the current thread calls the callback
+	static _HL_THREAD_LOCAL bool in_callback = false;
+
+	static void _close_async_file()
+	{
+		if (async_file.is_open())
+		{
+			async_file.close();
+		}
+		async_filename = "";
+	}
 	
 #ifdef _ANDROID
 	int Log::LevelWrite = (int)ANDROID_LOG_INFO;
@@ -62,8 +97,14 @@ namespace hltypes
 	bool Log::level_debug = true;
 #endif
 	Array<String> Log::tag_filters;
+	Array<unsigned long long> Log::tag_filter_hashes;
 	String Log::filename;
 	void (*Log::callback_function)(const String&, const String&) = NULL;
+	bool Log::async = false;
+	int Log::queue_size = 4096;
+	bool Log::drop_when_full = false;
+	int Log::dropped_count = 0;
+	Thread* Log::writer_thread = NULL;
 
 #ifdef _WIN32
 	static int fileIndex = 0;
@@ -91,6 +132,58 @@ namespace hltypes
 	}
 #endif
 	
+	void Log::setTagFilters(Array<String> value)
+	{
+		// both arrays are kept sorted by hash so a tag can be found with a binary search
+		Array<std::pair<unsigned long long, String> > entries;
+		foreach (String, it, value)
+		{
+			entries += std::pair<unsigned long long, String>((*it).hash(), (*it));
+		}
+		std::sort(entries.begin(), entries.end());
+		Log::tag_filters.clear();
+		Log::tag_filter_hashes.clear();
+		for_iter (i, 0, entries.size())
+		{
+			Log::tag_filter_hashes += entries[i].first;
+			Log::tag_filters += entries[i].second;
+		}
+	}
+
+	bool Log::isAllowed(const String& tag, int level)
+	{
+		if (level == LevelWrite && !Log::level_write)
+		{
+			return false;
+		}
+		if (level == LevelError && !Log::level_error)
+		{
+			return false;
+		}
+		if (level == LevelWarn && !Log::level_warn)
+		{
+			return false;
+		}
+		if (level == LevelDebug && !Log::level_debug)
+		{
+			return false;
+		}
+		if (tag != "" && Log::tag_filter_hashes.size() > 0)
+		{
+			unsigned long long hash = tag.hash();
+			std::vector<unsigned long long>::iterator it = std::lower_bound(Log::tag_filter_hashes.begin(), Log::tag_filter_hashes.end(), hash);
+			for (int i = it - Log::tag_filter_hashes.begin(); i < Log::tag_filter_hashes.size() && Log::tag_filter_hashes[i] == hash; ++i)
+			{
+				if (Log::tag_filters[i] == tag)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		return true;
+	}
+
 	void Log::setLevels(bool write, bool error, bool warn, bool debug)
 	{
 		Log::level_write = write;
@@ -101,6 +194,7 @@ namespace hltypes
 	
 	void Log::setFilename(const String& filename, bool clearFile)
 	{
+		Log::flush(); // queued messages still belong to the previous file
 		Log::filename = Dir::normalize(filename);
 		if (clearFile)
 		{
@@ -120,63 +214,316 @@ namespace hltypes
 	
 	bool Log::_system_log(const String& tag, const String& message, int level) // level is needed for Android
 	{
-		if (level == LevelWrite && !Log::level_write)
+		if (!Log::isAllowed(tag, level))
 		{
 			return false;
 		}
-		if (level == LevelError && !Log::level_error)
+		LogRecord record;
+		record.tag = tag;
+		record.message = message;
+		record.level = level;
+		queue_condition.lock();
+		// the callback could be running on the writer thread which would never make space in the queue
+		while (Log::async && log_queue.size() >= Log::queue_size && !Log::drop_when_full && !in_callback)
 		{
-			return false;
+			queue_condition.wait();
 		}
-		if (level == LevelWarn && !Log::level_warn)
+		if (Log::async)
 		{
-			return false;
+			if (log_queue.size() >= Log::queue_size && Log::drop_when_full)
+			{
+				++Log::dropped_count;
+				queue_condition.unlock();
+				return false;
+			}
+			log_queue += record;
+			if (log_queue.size() == 1)
+			{
+				queue_condition.broadcast(); // not empty anymore
+			}
+			queue_condition.unlock();
+			return true;
 		}
-		if (level == LevelDebug && !Log::level_debug)
+		queue_condition.unlock();
+		log_mutex.lock();
+		String data;
+		try
 		{
-			return false;
+			Log::_output(tag, message, level, data);
+			Log::_dump(data);
 		}
-		if (tag != "" && Log::tag_filters.size() > 0 && !Log::tag_filters.contains(tag))
+		catch (hltypes::exception& e)
 		{
-			return false;
+			_platform_print("FATAL", e.getMessage(), LevelError);
+			log_mutex.unlock();
+			throw e;
 		}
-		log_mutex.lock();
+		if (Log::callback_function != NULL)
+		{
+			// queued while log_mutex is still held so the callback gets messages in the same order as the output
+			callback_condition.lock();
+			callback_queue += record;
+			callback_condition.unlock();
+		}
+		log_mutex.unlock();
+		Log::_deliver_callbacks();
+		return true;
+	}
+	
+	void Log::_output(const String& tag, const String& message, int level, String& data)
+	{
 		_platform_print(tag, message, LEVEL_PLATFORM(level));
 		if (Log::filename != "")
 		{
-			try
-			{
+			data += (tag != "" ? "[" + tag + "] " + message : message) + "\n";
+		}
+	}
+	
+	void Log::_dump(const String& data)
+	{
+		if (Log::filename != "" && data != "")
+		{
 #ifndef _WIN32
-				hfile file(Log::filename, hfile::APPEND);
+			hfile file(Log::filename, hfile::APPEND);
 #else
-				hfile file(_get_current_file_name(Log::filename), hfile::APPEND);
+			hfile file(_get_current_file_name(Log::filename), hfile::APPEND);
 #endif
-				String log_message = (tag != "" ? "[" + tag + "] " + message : message);
-				file.writef("%s\n", log_message.c_str());
-			}
-			catch (hltypes::exception& e)
-			{
-				_platform_print("FATAL", e.getMessage(), LevelError);
-				log_mutex.unlock();
-				throw e;
-			}
+			file.write(data);
+		}
+	}
+	
+	bool Log::_process_queue()
+	{
+		log_mutex.lock();
+		// the queue is swapped out so producers are blocked only for a moment
+		Array<LogRecord> records;
+		queue_condition.lock();
+		if (log_queue.size() >= Log::queue_size)
+		{
+			queue_condition.broadcast(); // not full anymore
 		}
+		records.swap(log_queue);
+		queue_condition.unlock();
+		if (records.size() == 0)
+		{
+			log_mutex.unlock();
+			return false;
+		}
+		String data;
 		try
 		{
-			if (Log::callback_function != NULL)
+			foreach (LogRecord, it, records)
 			{
-				(*Log::callback_function)(tag, message);
+				Log::_output((*it).tag, (*it).message, (*it).level, data);
+			}
+			if (Log::filename != "" && data != "")
+			{
+				// the file stays open between batches and is only reopened when the name changes
+#ifndef _WIN32
+				String name = Log::filename;
+#else
+				String name = _get_current_file_name(Log::filename);
+#endif
+				if (!async_file.is_open() || async_filename != name)
+				{
+					_close_async_file();
+					async_file.open(name, hfile::APPEND);
+					async_filename = name;
+				}
+				async_file.write(data);
 			}
 		}
 		catch (hltypes::exception& e)
 		{
 			_platform_print("FATAL", e.getMessage(), LevelError);
-			log_mutex.unlock();
-			throw e;
+		}
+		if (Log::callback_function != NULL)
+		{
+			callback_condition.lock();
+			callback_queue += records;
+			callback_condition.unlock();
 		}
 		log_mutex.unlock();
+		Log::_deliver_callbacks();
 		return true;
 	}
+
+	void Log::_deliver_callbacks()
+	{
+		// the thread that is calling the callback takes over the messages of other threads so callbacks are called in order and
+		// never at the same time, but no thread ever waits for another thread's callback while holding a lock
+		callback_condition.lock();
+		if (delivering)
+		{
+			callback_condition.unlock();
+			return;
+		}
+		delivering = true;
+		Array<LogRecord> records;
+		void (*function)(const String&, const String&) = NULL;
+		while (callback_queue.size() > 0)
+		{
+			records.swap(callback_queue);
+			callback_condition.unlock();
+			in_callback = true;
+			foreach (LogRecord, it, records)
+			{
+				function = Log::callback_function;
+				if (function != NULL)
+				{
+					try
+					{
+						(*function)((*it).tag, (*it).message);
+					}
+					catch (hltypes::exception& e)
+					{
+						_platform_print("FATAL", e.getMessage(), LevelError);
+					}
+				}
+			}
+			in_callback = false;
+			records.clear();
+			callback_condition.lock();
+		}
+		delivering = false;
+		callback_condition.broadcast();
+		callback_condition.unlock();
+	}
+	
+	void Log::_async_writer(Thread* /*thread*/)
+	{
+		// the flag is used instead of Thread::isRunning() which can't be relied on before the thread has actually started
+		bool written = false;
+		queue_condition.lock();
+		while (Log::async)
+		{
+			if (log_queue.size() > 0)
+			{
+				queue_condition.unlock();
+				Log::_process_queue();
+				written = true;
+				queue_condition.lock();
+			}
+			else if (!written)
+			{
+				queue_condition.wait();
+			}
+			else if (!queue_condition.wait(ASYNC_IDLE_TIMEOUT) && log_queue.size() == 0)
+			{
+				// closed when idle so everything that was written can be read from the file
+				queue_condition.unlock();
+				log_mutex.lock();
+				_close_async_file();
+				log_mutex.unlock();
+				written = false;
+				queue_condition.lock();
+			}
+		}
+		queue_condition.unlock();
+	}
+
+	bool Log::isAsync()
+	{
+		queue_condition.lock();
+		bool result = Log::async;
+		queue_condition.unlock();
+		return result;
+	}
+	
+	void Log::setAsync(bool value)
+	{
+		queue_condition.lock();
+		if (Log::async == value)
+		{
+			queue_condition.unlock();
+			return;
+		}
+		Log::async = value;
+		if (value)
+		{
+			queue_condition.unlock();
+			Log::writer_thread = new Thread(&Log::_async_writer);
+			Log::writer_thread->start();
+		}
+		else
+		{
+			// wakes up the writer and producers that are waiting for free space in the queue
+			queue_condition.broadcast();
+			queue_condition.unlock();
+			Log::writer_thread->join();
+			delete Log::writer_thread;
+			Log::writer_thread = NULL;
+			// messages that were queued before turning it off
+			Log::_process_queue();
+			log_mutex.lock();
+			_close_async_file();
+			log_mutex.unlock();
+		}
+	}
+
+	int Log::getQueueSize()
+	{
+		queue_condition.lock();
+		int result = Log::queue_size;
+		queue_condition.unlock();
+		return result;
+	}
+
+	void Log::setQueueSize(int value)
+	{
+		queue_condition.lock();
+		Log::queue_size = hmax(value, 1);
+		// producers that are waiting might fit into a larger queue
+		queue_condition.broadcast();
+		queue_condition.unlock();
+	}
+
+	bool Log::isDropWhenFull()
+	{
+		queue_condition.lock();
+		bool result = Log::drop_when_full;
+		queue_condition.unlock();
+		return result;
+	}
+
+	void Log::setDropWhenFull(bool value)
+	{
+		queue_condition.lock();
+		Log::drop_when_full = value;
+		// producers that are waiting drop their messages now
+		queue_condition.broadcast();
+		queue_condition.unlock();
+	}
+
+	int Log::getDroppedCount()
+	{
+		queue_condition.lock();
+		int result = Log::dropped_count;
+		queue_condition.unlock();
+		return result;
+	}
+	
+	void Log::flush()
+	{
+		if (Log::isAsync())
+		{
+			Log::_process_queue();
+			// closed so everything that was written can be read from the file
+			log_mutex.lock();
+			_close_async_file();
+			log_mutex.unlock();
+			// the callback could still be busy with messages of the writer thread, unless it's the one that called this
+			if (!in_callback)
+			{
+				callback_condition.lock();
+				while (delivering || callback_queue.size() > 0)
+				{
+					callback_condition.wait();
+				}
+				callback_condition.unlock();
+			}
+		}
+	}
 	
 	bool Log::write(const String& tag, const String& message)
 	{
@@ -200,30 +547,48 @@ namespace hltypes
 	
 	bool Log::writef(const String& tag, const char* format, ...)
 	{
+		// filtering happens before formatting to avoid formatting messages that won't be logged
+		if (!Log::isAllowed(tag, LevelWrite))
+		{
+			return false;
+		}
 		MAKE_VA_ARGS(result, format);
 		return Log::write(tag, result);
 	}
 	
 	bool Log::errorf(const String& tag, const char* format, ...)
 	{
+		if (!Log::isAllowed(tag, LevelError))
+		{
+			return false;
+		}
 		MAKE_VA_ARGS(result, format);
 		return Log::error(tag, result);
 	}
 	
 	bool Log::warnf(const String& tag, const char* format, ...)
 	{
+		if (!Log::isAllowed(tag, LevelWarn))
+		{
+			return false;
+		}
 		MAKE_VA_ARGS(result, format);
 		return Log::warn(tag, result);
 	}
 	
 	bool Log::debugf(const String& tag, const char* format, ...)
 	{
+		if (!Log::isAllowed(tag, LevelDebug))
+		{
+			return false;
+		}
 		MAKE_VA_ARGS(result, format);
 		return Log::debug(tag, result);
 	}
 
 	void Log::finalize(bool clearFile)
 	{
+		Log::flush();
 #ifdef _WIN32
 		hfile file;
 		if (clearFile)
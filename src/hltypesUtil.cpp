@@ -21,6 +21,7 @@
 #include <time.h>
 
 #include "harray.h"
+#include "hcrc32.h"
 #include "hlog.h"
 #include "hltypesUtil.h"
 #include "hplatform.h"
@@ -337,44 +338,13 @@ hstr get_environment_variable(chstr name)
 
 // CRC32 stuff
 
-static unsigned int crc32_table[256];
-static bool crc32_table_created = false;
-void create_crc32_table()
-{
-	if (crc32_table_created)
-	{
-		return;
-	}
-	unsigned int polynome = 0xEDB88320;
-	unsigned int sum;
-	for_iter (i, 0, 256)
-	{
-		sum = i;
-		for_iter (j, 0, 8)
-		{
-			if ((sum & 1) != 0)
-			{
-				sum = ((sum >> 1) & 0x7FFFFFFF) ^ polynome;
-			}
-			else
-			{
-				sum = ((sum >> 1) & 0x7FFFFFFF);
-			}
-		}
-		crc32_table[i] = sum;
-	}
-	crc32_table_created = true;
-}
+#define CRC32_BUFFER_SIZE 16384
 
 unsigned int calc_crc32(unsigned char* data, long size)
 {
-	create_crc32_table();
-	unsigned int crc = 0xFFFFFFFF;
-	for_itert (long, i, 0, size)
-	{
-		crc = ((crc >> 8) & 0xFFFFFF) ^ crc32_table[(crc ^ data[i]) & 0xFF];
-	}
-	return ((crc & 0xFFFFFFFF) ^ 0xFFFFFFFF);
+	hcrc32 crc;
+	crc.update(data, size);
+	return crc.final();
 }
 
 unsigned int calc_crc32(hsbase* stream, long size)
@@ -383,11 +353,21 @@ unsigned int calc_crc32(hsbase* stream, long size)
 	{
 		return 0;
 	}
-	unsigned char* data = new unsigned char[size];
-	stream->read_raw(data, size);
-	unsigned int result = calc_crc32(data, size);
-	delete [] data;
-	return result;
+	// the data is processed in chunks so large streams don't have to be loaded into memory
+	unsigned char buffer[CRC32_BUFFER_SIZE];
+	hcrc32 crc;
+	int read = 0;
+	while (size > 0)
+	{
+		read = stream->read_raw(buffer, (int)hmin(size, (long)CRC32_BUFFER_SIZE));
+		if (read <= 0)
+		{
+			break;
+		}
+		crc.update(buffer, read);
+		size -= read;
+	}
+	return crc.final();
 }
 
 unsigned int calc_crc32(hsbase* stream)
@@ -10,15 +10,81 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#ifndef _WIN32
+#include <sys/time.h>
+#include <time.h>
+#endif
 
 #include "exception.h"
+#include "harray.h"
+#include "hcondition.h"
 #include "hltypesUtil.h"
 #include "hmutex.h"
 #include "hplatform.h"
+#include "hrwmutex.h"
+#include "hthreadpool.h"
+
+#define MAX_SPINS 100
 
 namespace hltypes
 {
-	Mutex::Mutex()
+	bool Mutex::statistics_enabled = false;
+
+	// allocated on first use and never released so named static Mutexes can be created and destroyed in any order
+	static Mutex* registry_mutex = NULL;
+	static Array<Mutex*>* registry = NULL;
+
+	static void _init_registry()
+	{
+		if (registry == NULL)
+		{
+			registry_mutex = new Mutex();
+			registry = new Array<Mutex*>();
+		}
+	}
+
+	// high resolution time in miliseconds, only used for measuring intervals
+	static double _get_time()
+	{
+#ifdef _WIN32
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER counter;
+		QueryPerformanceFrequency(&frequency);
+		QueryPerformanceCounter(&counter);
+		return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+		// unlike gettimeofday() not affected by changes of the system time
+		timespec ts = {0, 0};
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#else
+		timeval tv = {0, 0};
+		gettimeofday(&tv, NULL);
+		return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+	}
+
+	// tells the CPU that the thread is spinning so it can save power and give resources to a hyper-threaded sibling
+	static inline void _cpu_pause()
+	{
+#ifdef _WIN32
+		YieldProcessor();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+		__asm__ __volatile__("pause");
+#elif defined(__GNUC__) && defined(__aarch64__)
+		__asm__ __volatile__("yield");
+#endif
+	}
+
+	MutexStatistics::MutexStatistics() : acquisitions(0), contentions(0), wait_time(0.0)
+	{
+	}
+
+	MutexStatistics::~MutexStatistics()
+	{
+	}
+
+	Mutex::Mutex(const String& name) : adaptive(false), spin_estimate(0), held(false)
 	{
 #ifdef _WIN32
 #ifndef _WINRT // WinXP does not have CreateMutexEx()
@@ -34,10 +100,25 @@ namespace hltypes
 		this->handle = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
 		pthread_mutex_init((pthread_mutex_t*)this->handle, 0);
 #endif
+		this->name = name;
+		this->statistics.name = name;
+		if (this->name != "")
+		{
+			_init_registry();
+			registry_mutex->lock();
+			(*registry) += this;
+			registry_mutex->unlock();
+		}
 	}
 
 	Mutex::~Mutex()
 	{
+		if (this->name != "")
+		{
+			registry_mutex->lock();
+			registry->remove(this);
+			registry_mutex->unlock();
+		}
 #ifdef _WIN32
 		CloseHandle(this->handle);
 #else
@@ -49,21 +130,183 @@ namespace hltypes
 
 	void Mutex::lock()
 	{
-#ifdef _WIN32
-		WaitForSingleObjectEx(this->handle, INFINITE, FALSE);
+		if (this->_try_lock())
+		{
+			if (Mutex::statistics_enabled)
+			{
+				++this->statistics.acquisitions;
+			}
+			return;
+		}
+		double time = (Mutex::statistics_enabled ? _get_time() : 0.0);
+		bool locked = false;
+		if (this->adaptive)
+		{
+			// similar to glibc's adaptive mutexes, the spin limit follows the average number of spins that were needed
+			int limit = hmin(this->spin_estimate * 2 + 10, MAX_SPINS);
+			int spins = 0;
+			while (spins < limit)
+			{
+				++spins;
+				// the flag is only read while spinning so the cache line of the Mutex isn't written until it seems to be free
+				if (!this->held && this->_try_lock())
+				{
+					locked = true;
+					break;
+				}
+				_cpu_pause();
+			}
+			if (!locked)
+			{
+				this->_lock();
+			}
+			this->spin_estimate += (spins - this->spin_estimate) / 8;
+		}
+		else
+		{
+			this->_lock();
+		}
+		if (Mutex::statistics_enabled)
+		{
+			++this->statistics.acquisitions;
+			++this->statistics.contentions;
+			this->statistics.wait_time += _get_time() - time;
+		}
+	}
+
+	void Mutex::setAdaptive(bool value)
+	{
+#ifndef _WIN32
+		// spinning can't help if the owner of the Mutex can't run at the same time
+		this->adaptive = (value && ThreadPool::getCpuCount() > 1);
 #else
-		pthread_mutex_lock((pthread_mutex_t*)this->handle);
+		// locking a kernel mutex always is a system call so spinning on it would only add more system calls
+		(void)value;
+		this->adaptive = false;
 #endif
 	}
 
 	void Mutex::unlock()
 	{
+		this->held = false;
 #ifdef _WIN32
 		ReleaseMutex(this->handle);
 #else
 		pthread_mutex_unlock((pthread_mutex_t*)this->handle);
 #endif
 	}
+
+	MutexStatistics Mutex::getStatistics()
+	{
+		this->_lock();
+		MutexStatistics result = this->statistics;
+		this->unlock();
+		return result;
+	}
+
+	void Mutex::resetStatistics()
+	{
+		this->_lock();
+		this->statistics = MutexStatistics();
+		this->statistics.name = this->name;
+		this->unlock();
+	}
+
+	Array<MutexStatistics> Mutex::getAllStatistics()
+	{
+		Array<MutexStatistics> result;
+		MutexStatistics statistics;
+		_init_registry();
+		// the values are copied without locking the Mutexes, otherwise the registry lock would be held while other locks are taken
+		// and calling this while holding a named Mutex would deadlock, the registry lock only keeps the Mutexes from being destroyed
+		registry_mutex->lock();
+		foreach (Mutex*, it, (*registry))
+		{
+			statistics.name = (*it)->name;
+			statistics.acquisitions = (*it)->statistics.acquisitions;
+			statistics.contentions = (*it)->statistics.contentions;
+			statistics.wait_time = (*it)->statistics.wait_time;
+			result += statistics;
+		}
+		registry_mutex->unlock();
+		return result;
+	}
+
+	bool Mutex::_try_lock()
+	{
+#ifdef _WIN32
+		bool result = (WaitForSingleObjectEx(this->handle, 0, FALSE) == WAIT_OBJECT_0);
+#else
+		bool result = (pthread_mutex_trylock((pthread_mutex_t*)this->handle) == 0);
+#endif
+		if (result)
+		{
+			this->held = true;
+		}
+		return result;
+	}
+
+	void Mutex::_lock()
+	{
+#ifdef _WIN32
+		WaitForSingleObjectEx(this->handle, INFINITE, FALSE);
+#else
+		pthread_mutex_lock((pthread_mutex_t*)this->handle);
+#endif
+		this->held = true;
+	}
+
+	ScopeLock::ScopeLock(Mutex* mutex) : mutex(mutex), condition(NULL), rw_mutex(NULL), write(false)
+	{
+		this->mutex->lock();
+	}
+
+	ScopeLock::ScopeLock(Condition* condition) : mutex(NULL), condition(condition), rw_mutex(NULL), write(false)
+	{
+		this->condition->lock();
+	}
+
+	ScopeLock::ScopeLock(ReadWriteMutex* rw_mutex, bool write) : mutex(NULL), condition(NULL), rw_mutex(rw_mutex), write(write)
+	{
+		if (this->write)
+		{
+			this->rw_mutex->lock_write();
+		}
+		else
+		{
+			this->rw_mutex->lock_read();
+		}
+	}
+
+	ScopeLock::~ScopeLock()
+	{
+		this->release();
+	}
+
+	void ScopeLock::release()
+	{
+		if (this->mutex != NULL)
+		{
+			this->mutex->unlock();
+			this->mutex = NULL;
+		}
+		if (this->condition != NULL)
+		{
+			this->condition->unlock();
+			this->condition = NULL;
+		}
+		if (this->rw_mutex != NULL)
+		{
+			if (this->write)
+			{
+				this->rw_mutex->unlock_write();
+			}
+			else
+			{
+				this->rw_mutex->unlock_read();
+			}
+			this->rw_mutex = NULL;
+		}
+	}
 	
 }
-
@@ -0,0 +1,78 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+
+#include "hltypesUtil.h"
+#include "hmutex.h"
+#include "hparallel.h"
+#include "hthreadpool.h"
+
+// parts smaller than this are not worth the overhead of a task
+#define MINIMUM_PART_SIZE 4096
+// more parts than threads let idle workers steal work when parts take different amounts of time
+#define PARTS_PER_THREAD 4
+
+namespace hltypes
+{
+	static int minimumSize = 16384;
+	static ThreadPool* threadPool = NULL;
+	static ThreadPool* sharedThreadPool = NULL;
+	static bool sharedThreadPoolCreated = false;
+	static Mutex mutex("hltypes::Parallel::mutex");
+
+	int Parallel::getMinimumSize()
+	{
+		return minimumSize;
+	}
+
+	void Parallel::setMinimumSize(int value)
+	{
+		minimumSize = hmax(value, 1);
+	}
+
+	ThreadPool* Parallel::getThreadPool()
+	{
+		ScopeLock lock(&mutex);
+		if (threadPool != NULL)
+		{
+			return threadPool;
+		}
+		if (!sharedThreadPoolCreated)
+		{
+			// the calling thread does work as well
+			int count = ThreadPool::getCpuCount() - 1;
+			if (count > 0)
+			{
+				sharedThreadPool = new ThreadPool(count);
+			}
+			sharedThreadPoolCreated = true;
+		}
+		return sharedThreadPool;
+	}
+
+	void Parallel::setThreadPool(ThreadPool* value)
+	{
+		ScopeLock lock(&mutex);
+		threadPool = value;
+	}
+
+	int Parallel::_get_part_count(int size)
+	{
+		if (size < minimumSize)
+		{
+			return 1;
+		}
+		ThreadPool* pool = Parallel::getThreadPool();
+		if (pool == NULL)
+		{
+			return 1;
+		}
+		return hclamp(size / MINIMUM_PART_SIZE, 1, (pool->getWorkerCount() + 1) * PARTS_PER_THREAD);
+	}
+
+}
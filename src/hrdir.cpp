@@ -22,6 +22,7 @@ namespace hltypes
 {
 	Map<String, Array<String> > ResourceDir::cacheDirectories;
 	Map<String, Array<String> > ResourceDir::cacheFiles;
+	ReadWriteMutex ResourceDir::cacheMutex;
 
 	bool ResourceDir::exists(const String& dirname, bool case_sensitive)
 	{
@@ -31,23 +32,7 @@ namespace hltypes
 			return true;
 		}
 #ifdef _ZIPRESOURCE
-		bool result = ResourceDir::directories(ResourceDir::basedir(name)).contains(ResourceDir::basename(name));
-		if (!result && !case_sensitive)
-		{
-			hstr basedir = ResourceDir::basedir(name);
-			hstr basename = ResourceDir::basename(name);
-			Array<String> directories = ResourceDir::directories(basedir);
-			foreach (String, it, directories)
-			{
-				if ((*it).lower() == basename.lower())
-				{
-					name = ResourceDir::join_path(basedir, (*it));
-					result = true;
-					break;
-				}
-			}
-		}
-		return result;
+		return zip::directoryExists(Resource::make_full_path(name), case_sensitive);
 #else
 		return Dir::exists(Resource::make_full_path(name), case_sensitive);
 #endif
@@ -70,8 +55,16 @@ namespace hltypes
 #ifdef _ZIPRESOURCE
 		Array<String> result = ResourceDir::directories(dirname, false) + ResourceDir::files(dirname, false);
 #else
-		String name = Resource::make_full_path(dirname);
-		Array<String> result = ResourceDir::_remove_cwd(Dir::directories(name, false) + Dir::files(name, false)).removed_duplicates();
+		Array<DirEntry> entries = Dir::scan(Resource::make_full_path(dirname));
+		Array<String> result;
+		foreach (DirEntry, it, entries)
+		{
+			if ((*it).type != DirEntry::OTHER)
+			{
+				result += (*it).name;
+			}
+		}
+		result = ResourceDir::_remove_cwd(result);
 #endif
 		if (prepend_dir)
 		{
@@ -85,27 +78,26 @@ namespace hltypes
 		String name = Resource::make_full_path(dirname);
 		Array<String> result;
 #ifdef _ZIPRESOURCE
-		if (ResourceDir::cacheDirectories.has_key(name))
+		ResourceDir::cacheMutex.lock_read();
+		bool cached = ResourceDir::cacheDirectories.has_key(name);
+		if (cached)
 		{
 			result = ResourceDir::cacheDirectories[name];
 		}
-		else
+		ResourceDir::cacheMutex.unlock_read();
+		if (!cached)
 		{
-			Array<String> files = ResourceDir::_get_internal_files();
-			String current;
-			foreach (String, it, files)
+			result = zip::getDirectories(name);
+			// empty listings aren't cached, because the archive might not have been indexed yet
+			if (result.size() > 0)
 			{
-				current = (*it);
-				if (ResourceDir::_check_dir_prefix(current, name) && current != "" && current.contains('/'))
-				{
-					result += current.split('/', 1).first();
-				}
+				ResourceDir::cacheMutex.lock_write();
+				ResourceDir::cacheDirectories[name] = result;
+				ResourceDir::cacheMutex.unlock_write();
 			}
-			result.remove_duplicates();
-			ResourceDir::cacheDirectories[name] = result;
 		}
 #else
-		result = ResourceDir::_remove_cwd(Dir::directories(name, false)).removed_duplicates();
+		result = ResourceDir::_remove_cwd(Dir::directories(name, false));
 #endif
 		if (prepend_dir)
 		{
@@ -119,27 +111,25 @@ namespace hltypes
 		String name = Resource::make_full_path(dirname);
 		Array<String> result;
 #ifdef _ZIPRESOURCE
-		if (ResourceDir::cacheFiles.has_key(name))
+		ResourceDir::cacheMutex.lock_read();
+		bool cached = ResourceDir::cacheFiles.has_key(name);
+		if (cached)
 		{
 			result = ResourceDir::cacheFiles[name];
 		}
-		else
+		ResourceDir::cacheMutex.unlock_read();
+		if (!cached)
 		{
-			Array<String> files = ResourceDir::_get_internal_files();
-			String current;
-			foreach (String, it, files)
+			result = zip::getFiles(name);
+			if (result.size() > 0)
 			{
-				current = (*it);
-				if (ResourceDir::_check_dir_prefix(current, name) && current != "" && !current.contains('/'))
-				{
-					result += current;
-				}
+				ResourceDir::cacheMutex.lock_write();
+				ResourceDir::cacheFiles[name] = result;
+				ResourceDir::cacheMutex.unlock_write();
 			}
-			result.remove_duplicates();
-			ResourceDir::cacheFiles[name] = result;
 		}
 #else
-		result = ResourceDir::_remove_cwd(Dir::files(name, false)).removed_duplicates();
+		result = ResourceDir::_remove_cwd(Dir::files(name, false));
 #endif
 		if (prepend_dir)
 		{
@@ -174,12 +164,7 @@ namespace hltypes
 	{
 		Array<String> files;
 #ifdef _ZIPRESOURCE
-		void* a = zip::open(NULL); // NULL, because this is a static function which will close the archive right after it is done
-		if (a != NULL)
-		{
-			files = zip::getFiles(a);
-			zip::close(NULL, a);
-		}
+		files = zip::getAllFiles();
 #endif
 		return files;
 	}
@@ -23,20 +23,17 @@ namespace hltypes
 	String Resource::cwd = ".";
 #else
 	String Resource::cwd = "assets";
-#define READ_BUFFER_SIZE 65536
-	static unsigned char _read_buffer[READ_BUFFER_SIZE] = {0};
 #endif
 	String Resource::archive = "";
 
 	void Resource::setArchive(const String& value)
 	{
 #ifdef _ZIPRESOURCE
-		if (archive != value)
-		{
-			hrdir::cacheDirectories.clear();
-			hrdir::cacheFiles.clear();
-		}
 		zip::setArchive(value);
+		ResourceDir::cacheMutex.lock_write();
+		ResourceDir::cacheDirectories.clear();
+		ResourceDir::cacheFiles.clear();
+		ResourceDir::cacheMutex.unlock_write();
 #endif
 		archive = value;
 	}
@@ -127,6 +124,45 @@ namespace hltypes
 #endif
 	}
 
+	long Resource::getCacheSize()
+	{
+#ifndef _ZIPRESOURCE
+		return 0;
+#else
+		return zip::getCacheSize();
+#endif
+	}
+
+	void Resource::setCacheSize(long value)
+	{
+#ifdef _ZIPRESOURCE
+		zip::setCacheSize(value);
+#else
+		(void)value; // only ZIP resources are cached
+#endif
+	}
+
+	void Resource::clearCache()
+	{
+#ifdef _ZIPRESOURCE
+		zip::clearCache();
+#endif
+	}
+
+	void Resource::preload(const Array<String>& filenames)
+	{
+#ifdef _ZIPRESOURCE
+		Array<String> names;
+		foreachc (String, it, filenames)
+		{
+			names += Resource::make_full_path(*it);
+		}
+		zip::preload(names);
+#else
+		(void)filenames; // only ZIP resources are cached
+#endif
+	}
+
 	void Resource::_update_data_size()
 	{
 #ifndef _ZIPRESOURCE
@@ -135,7 +171,7 @@ namespace hltypes
 		this->data_size = this->_position();
 		this->_fseek(position, START);
 #else
-		this->data_size = zip::fsize(this->archivefile, this->filename);
+		this->data_size = zip::fsize(Resource::make_full_path(this->filename));
 #endif
 	}
 
@@ -144,9 +180,9 @@ namespace hltypes
 #ifndef _ZIPRESOURCE
 		return this->_fread(buffer, size, count);
 #else
-		int read_count = size * count;
-		this->data_position += read_count;
-		return zip::fread(this->cfile, buffer, read_count);
+		long result = zip::fread(this->cfile, buffer, size * count);
+		this->data_position += result;
+		return result;
 #endif
 	}
 	
@@ -178,7 +214,6 @@ namespace hltypes
 #ifndef _ZIPRESOURCE
 		this->_fseek(offset, seek_mode);
 #else
-		// zip can only read forward and doesn't really have seeking
 		long target = offset;
 		switch (seek_mode)
 		{
@@ -192,31 +227,8 @@ namespace hltypes
 			target = this->data_size + offset;
 			break;
 		}
-		if (target >= this->data_position)
-		{
-			target -= this->data_position;
-		}
-		else
-		{
-			// reopening the file as the target position was already passed
-			this->cfile = zip::freopen(this->cfile, this->archivefile, Resource::make_full_path(this->filename));
-			this->data_position = 0;
-		}
-		if (target > 0)
-		{
-			// seeking in a compressed stream is not possible so the data has to be read and then discarded
-			// the buffer can be static, because this data isn't used so there will be no threading problems
-			unsigned char* buffer = _read_buffer;
-			if (target > READ_BUFFER_SIZE)
-			{
-				buffer = new unsigned char[target];
-			}
-			this->_read(buffer, 1, target);
-			if (target > READ_BUFFER_SIZE)
-			{
-				delete [] buffer;
-			}
-		}
+		// compressed data can't be seeked directly so zip::fseek resumes decompression from the closest known position
+		this->data_position = zip::fseek(this->cfile, target);
 #endif
 	}
 	
@@ -225,41 +237,22 @@ namespace hltypes
 #ifndef _ZIPRESOURCE
 		return FileBase::_fexists(Resource::make_full_path(filename), case_sensitive);
 #else
-		bool result = false;
-		void* a = zip::open(NULL); // NULL, because this is a static function which will close the archive right after it is done
-		if (a != NULL)
-		{
-			void* f = zip::fopen(a, Resource::make_full_path(filename));
-			if (f != NULL)
-			{
-				zip::fclose(f);
-				result = true;
-			}
-			if (!result && !case_sensitive)
-			{
-				hstr name = filename;
-				hstr basedir = ResourceDir::basedir(name);
-				hstr basename = ResourceDir::basename(name);
-				Array<String> files = ResourceDir::files(basedir);
-				foreach (String, it, files)
-				{
-					if ((*it).lower() == basename.lower())
-					{
-						name = ResourceDir::join_path(basedir, (*it));
-						result = true;
-						break;
-					}
-				}
-			}
-			zip::close(NULL, a);
-		}
-		return result;
+		return zip::exists(Resource::make_full_path(filename), case_sensitive);
 #endif
 	}
 	
 	long Resource::hsize(const String& filename)
 	{
+#ifndef _ZIPRESOURCE
 		return Resource(filename).size();
+#else
+		String name = Resource::make_full_path(filename);
+		if (!zip::exists(name, true))
+		{
+			throw resource_not_found(filename);
+		}
+		return zip::fsize(name);
+#endif
 	}
 	
 	String Resource::hread(const String& filename, int count)
@@ -277,13 +270,11 @@ namespace hltypes
 #ifndef _ZIPRESOURCE
 		return File::get_info(Resource::make_full_path(filename));
 #else
+		String name = Resource::make_full_path(filename);
 		FileInfo info;
-		bool result = false;
-		void* a = zip::open(NULL); // NULL, because this is a static function which will close the archive right after it is done
-		if (a != NULL)
+		if (zip::exists(name, true))
 		{
-			info = zip::finfo(a, Resource::make_full_path(filename));
-			zip::close(NULL, a);
+			info = zip::finfo(name);
 			FileInfo archive = File::get_info(Resource::archive);
 			info.creation_time = archive.creation_time;
 			info.access_time = archive.access_time;
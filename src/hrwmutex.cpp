@@ -0,0 +1,83 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+
+#if defined(_WIN32) && (!defined(_WIN32_WINNT) || _WIN32_WINNT < 0x0600)
+// slim reader/writer locks require Windows Vista or later
+#undef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hltypesUtil.h"
+#include "hplatform.h"
+#include "hrwmutex.h"
+
+namespace hltypes
+{
+	ReadWriteMutex::ReadWriteMutex()
+	{
+#ifdef _WIN32
+		this->handle = (SRWLOCK*)malloc(sizeof(SRWLOCK));
+		InitializeSRWLock((SRWLOCK*)this->handle);
+#else
+		this->handle = (pthread_rwlock_t*)malloc(sizeof(pthread_rwlock_t));
+		pthread_rwlock_init((pthread_rwlock_t*)this->handle, 0);
+#endif
+	}
+
+	ReadWriteMutex::~ReadWriteMutex()
+	{
+#ifdef _WIN32
+		free((SRWLOCK*)this->handle);
+#else
+		pthread_rwlock_destroy((pthread_rwlock_t*)this->handle);
+		free((pthread_rwlock_t*)this->handle);
+#endif
+		this->handle = NULL;
+	}
+
+	void ReadWriteMutex::lock_read()
+	{
+#ifdef _WIN32
+		AcquireSRWLockShared((SRWLOCK*)this->handle);
+#else
+		pthread_rwlock_rdlock((pthread_rwlock_t*)this->handle);
+#endif
+	}
+
+	void ReadWriteMutex::unlock_read()
+	{
+#ifdef _WIN32
+		ReleaseSRWLockShared((SRWLOCK*)this->handle);
+#else
+		pthread_rwlock_unlock((pthread_rwlock_t*)this->handle);
+#endif
+	}
+
+	void ReadWriteMutex::lock_write()
+	{
+#ifdef _WIN32
+		AcquireSRWLockExclusive((SRWLOCK*)this->handle);
+#else
+		pthread_rwlock_wrlock((pthread_rwlock_t*)this->handle);
+#endif
+	}
+
+	void ReadWriteMutex::unlock_write()
+	{
+#ifdef _WIN32
+		ReleaseSRWLockExclusive((SRWLOCK*)this->handle);
+#else
+		pthread_rwlock_unlock((pthread_rwlock_t*)this->handle);
+#endif
+	}
+
+}
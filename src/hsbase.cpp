@@ -19,7 +19,44 @@
 
 namespace hltypes
 {
-	StreamBase::StreamBase(unsigned char encryption_offset) : data_size(0)
+	static int _find_delimiter(const char* data, int size, const char* delimiter, int delimiter_size)
+	{
+		const char* end = data + size - delimiter_size + 1;
+		const char* current = data;
+		while (current < end)
+		{
+			current = (const char*)memchr(current, delimiter[0], end - current);
+			if (current == NULL)
+			{
+				break;
+			}
+			if (memcmp(current, delimiter, delimiter_size) == 0)
+			{
+				return (int)(current - data);
+			}
+			++current;
+		}
+		return -1;
+	}
+
+	static void _append_without_cr(String& result, const char* data, int size)
+	{
+		const char* end = data + size;
+		const char* cr;
+		while (data < end)
+		{
+			cr = (const char*)memchr(data, '\r', end - data);
+			if (cr == NULL)
+			{
+				result.append(data, end - data);
+				break;
+			}
+			result.append(data, cr - data);
+			data = cr + 1;
+		}
+	}
+
+	StreamBase::StreamBase(unsigned char encryption_offset) : data_size(0), batch_depth(0), batch_dirty(false)
 	{
 		this->encryption_offset = encryption_offset;
 	}
@@ -53,12 +90,14 @@ namespace hltypes
 	long StreamBase::size()
 	{
 		this->_check_availability();
+		this->_flush_data_size();
 		return this->data_size;
 	}
 	
 	bool StreamBase::eof()
 	{
 		this->_check_availability();
+		this->_flush_data_size();
 		// "feof" doesn't really work if you use a write mode, so we use our own detection
 		return (this->_position() >= this->data_size);
 	}
@@ -67,30 +106,45 @@ namespace hltypes
 	{
 		this->_check_availability();
 		String result;
-		Array<String> parts;
+		int delimiter_size = delimiter.size();
+		if (delimiter_size == 0)
+		{
+			// the whole rest of the stream is read so the result can be allocated right away
+			result.reserve(hmax(this->data_size - this->_position(), 0L));
+		}
+		// the last (delimiter_size - 1) bytes are kept back after every chunk in case the delimiter spans two chunks
+		int carry = hmax(delimiter_size - 1, 0);
+		char* buffer = new char[carry + BUFFER_SIZE];
+		int size = 0;
 		int count;
 		int index;
 		while (!this->eof())
 		{
-			char c[BUFFER_SIZE + 1] = {'\0'};
-			count = this->_read(c, 1, BUFFER_SIZE);
-			if (count == 0)
+			count = this->_read(&buffer[size], 1, BUFFER_SIZE);
+			if (count <= 0)
 			{
 				break;
 			}
-			result += c;
-			if (delimiter != "")
+			size += count;
+			if (delimiter_size > 0)
 			{
-				index = result.find(delimiter);
+				// only the newly read bytes and the carried over ones are scanned
+				index = _find_delimiter(buffer, size, delimiter.c_str(), delimiter_size);
 				if (index >= 0)
 				{
-					this->_seek(index - result.size() + delimiter.size(), CURRENT);
-					result = result(0, index);
-					break;
+					_append_without_cr(result, buffer, index);
+					this->_seek(index + delimiter_size - size, CURRENT);
+					delete [] buffer;
+					return result;
 				}
 			}
+			count = hmax(size - carry, 0);
+			_append_without_cr(result, buffer, count);
+			size -= count;
+			memmove(buffer, &buffer[count], size);
 		}
-		result = result.replace("\r", "");
+		_append_without_cr(result, buffer, size);
+		delete [] buffer;
 		return result;
 	}
 	
@@ -132,21 +186,21 @@ namespace hltypes
 	{
 		this->_check_availability();
 		this->_write(text.c_str(), 1, text.size());
-		this->_update_data_size();
+		this->_data_written();
 	}
 	
 	void StreamBase::write(const char* text)
 	{
 		this->_check_availability();
 		this->_write(text, 1, strlen(text));
-		this->_update_data_size();
+		this->_data_written();
 	}
 	
 	void StreamBase::write_line(const String& text)
 	{
 		this->_check_availability();
 		this->_write((text + "\n").c_str(), 1, text.size() + 1);
-		this->_update_data_size();
+		this->_data_written();
 	}
 	
 	void StreamBase::write_line(const char* text)
@@ -173,7 +227,7 @@ namespace hltypes
 	{
 		this->_check_availability();
 		int result = this->_write(buffer, 1, count);
-		this->_update_data_size();
+		this->_data_written();
 		return result;
 	}
 		
@@ -186,7 +240,7 @@ namespace hltypes
 		stream.seek(-count);
 		int result = this->_write(buffer, 1, count);
 		delete [] buffer;
-		this->_update_data_size();
+		this->_data_written();
 		return result;
 	}
 	
@@ -204,6 +258,101 @@ namespace hltypes
 		this->_seek(position, START);
 	}
 
+	void StreamBase::_data_written()
+	{
+		if (this->batch_depth > 0)
+		{
+			this->batch_dirty = true;
+		}
+		else
+		{
+			this->_update_data_size();
+		}
+	}
+
+	void StreamBase::_flush_data_size()
+	{
+		if (this->batch_dirty)
+		{
+			this->batch_dirty = false;
+			this->_update_data_size();
+		}
+	}
+
+	void StreamBase::begin_batch()
+	{
+		++this->batch_depth;
+	}
+
+	void StreamBase::end_batch()
+	{
+		if (this->batch_depth > 0)
+		{
+			--this->batch_depth;
+			if (this->batch_depth == 0 && this->is_open())
+			{
+				this->_flush_data_size();
+			}
+		}
+	}
+
+	void StreamBase::_dump_elements(const void* data, int element_size, int count)
+	{
+		this->_check_availability();
+		if (count <= 0)
+		{
+			return;
+		}
+#ifndef __BIG_ENDIAN__
+		this->_write(data, element_size, count);
+#else
+		// elements are always stored in little endian byte order, so they are swapped in chunks
+		const unsigned char* source = (const unsigned char*)data;
+		unsigned char buffer[BUFFER_SIZE];
+		int chunk_count = hmax(BUFFER_SIZE / element_size, 1);
+		int current = 0;
+		while (count > 0)
+		{
+			current = hmin(count, chunk_count);
+			for_iter (i, 0, current)
+			{
+				for_iter (j, 0, element_size)
+				{
+					buffer[i * element_size + j] = source[i * element_size + element_size - 1 - j];
+				}
+			}
+			this->_write(buffer, element_size, current);
+			source += current * element_size;
+			count -= current;
+		}
+#endif
+		this->_data_written();
+	}
+
+	int StreamBase::_load_elements(void* data, int element_size, int count)
+	{
+		this->_check_availability();
+		if (count <= 0)
+		{
+			return 0;
+		}
+		int result = (int)(this->_read(data, 1, element_size * count) / element_size);
+#ifdef __BIG_ENDIAN__
+		unsigned char* bytes = (unsigned char*)data;
+		unsigned char c;
+		for_iter (i, 0, result)
+		{
+			for_iter (j, 0, element_size / 2)
+			{
+				c = bytes[i * element_size + j];
+				bytes[i * element_size + j] = bytes[i * element_size + element_size - 1 - j];
+				bytes[i * element_size + element_size - 1 - j] = c;
+			}
+		}
+#endif
+		return result;
+	}
+
 	void StreamBase::_check_availability()
 	{
 		if (!this->is_open())
@@ -216,14 +365,14 @@ namespace hltypes
 	{
 		this->_check_availability();
 		this->_write(&c, 1, 1);
-		this->_update_data_size();
+		this->_data_written();
 	}
 
 	void StreamBase::dump(unsigned char c)
 	{
 		this->_check_availability();
 		this->_write(&c, 1, 1);
-		this->_update_data_size();
+		this->_data_written();
 	}
 
 	void StreamBase::dump(int i)
@@ -244,7 +393,7 @@ namespace hltypes
 		bytes[0] = i & 0xFF;
 		this->_write(bytes, 1, 4);
 #endif
-		this->_update_data_size();
+		this->_data_written();
 	}
 
 	void StreamBase::dump(long l)
@@ -282,7 +431,7 @@ namespace hltypes
 		bytes[0] = l & 0xFF;
 		this->_write(bytes, 1, 8);
 #endif
-		this->_update_data_size();
+		this->_data_written();
 	}
 
 	void StreamBase::dump(short s)
@@ -301,7 +450,7 @@ namespace hltypes
 		bytes[0] = s & 0xFF;
 		this->_write(bytes, 1, 2);
 #endif
-		this->_update_data_size();
+		this->_data_written();
 	}
 
 	void StreamBase::dump(float f)
@@ -309,7 +458,7 @@ namespace hltypes
 #ifndef __BIG_ENDIAN__
 		this->_check_availability();
 		this->_write((unsigned char*)&f, 1, 4);
-		this->_update_data_size();
+		this->_data_written();
 #else
 		// some data voodoo magic
 		this->dump(*((unsigned int*)&f));
@@ -321,7 +470,7 @@ namespace hltypes
 #ifndef __BIG_ENDIAN__
 		this->_check_availability();
 		this->_write((unsigned char*)&d, 1, 8);
-		this->_update_data_size();
+		this->_data_written();
 #else
 		// some more data voodoo magic, but this time we make 100% sure it uses 8 bytes
 		this->dump(*((unsigned int*)&d));
@@ -334,7 +483,7 @@ namespace hltypes
 		this->_check_availability();
 		unsigned char c = (b ? 1 : 0);
 		this->_write(&c, 1, 1);
-		this->_update_data_size();
+		this->_data_written();
 	}
 
 	void StreamBase::dump(const String& str)
@@ -361,7 +510,7 @@ namespace hltypes
 				delete [] c;
 			}
 		}
-		this->_update_data_size();
+		this->_data_written();
 	}
 
 	void StreamBase::dump(const char* c)
@@ -538,4 +687,99 @@ namespace hltypes
 		return this->load_hstr();
 	}
 
+	LineCursor::LineCursor(StreamBase* stream) : buffer(NULL), capacity(0), start(0), end(0), line(NULL), size(0)
+	{
+		this->stream = stream;
+		this->stream->_check_availability();
+	}
+
+	LineCursor::~LineCursor()
+	{
+		if (this->end > this->start && this->stream->_is_open())
+		{
+			// data that was read ahead, but not returned yet, is given back to the stream
+			this->stream->_seek(this->start - this->end, StreamBase::CURRENT);
+		}
+		if (this->buffer != NULL)
+		{
+			delete [] this->buffer;
+		}
+	}
+
+	bool LineCursor::next()
+	{
+		long available = 0;
+		const char* data = (const char*)this->stream->_direct_data(available);
+		if (data != NULL && this->end == this->start)
+		{
+			// in-memory data doesn't need to be copied at all
+			if (available <= 0)
+			{
+				return false;
+			}
+			const char* newline = (const char*)memchr(data, '\n', available);
+			int count = (newline != NULL ? (int)(newline - data) : (int)available);
+			this->_set_line(data, count);
+			this->stream->_seek(newline != NULL ? count + 1 : count, StreamBase::CURRENT);
+			return true;
+		}
+		int scanned = this->start;
+		int count;
+		while (true)
+		{
+			const char* newline = (const char*)memchr(&this->buffer[scanned], '\n', this->end - scanned);
+			if (newline != NULL)
+			{
+				count = (int)(newline - &this->buffer[this->start]);
+				this->_set_line(&this->buffer[this->start], count);
+				this->start += count + 1;
+				return true;
+			}
+			// the buffer is refilled and grows only if a single line doesn't fit
+			if (this->start > 0)
+			{
+				memmove(this->buffer, &this->buffer[this->start], this->end - this->start);
+				this->end -= this->start;
+				this->start = 0;
+			}
+			scanned = this->end;
+			if (this->end == this->capacity)
+			{
+				int new_capacity = hmax(this->capacity * 2, BUFFER_SIZE);
+				char* new_buffer = new char[new_capacity];
+				if (this->buffer != NULL)
+				{
+					memcpy(new_buffer, this->buffer, this->end);
+					delete [] this->buffer;
+				}
+				this->buffer = new_buffer;
+				this->capacity = new_capacity;
+			}
+			count = this->stream->_read(&this->buffer[this->end], 1, this->capacity - this->end);
+			if (count <= 0)
+			{
+				break;
+			}
+			this->end += count;
+		}
+		if (this->end == this->start)
+		{
+			return false;
+		}
+		// last line without \n at the end
+		this->_set_line(&this->buffer[this->start], this->end - this->start);
+		this->start = this->end;
+		return true;
+	}
+
+	void LineCursor::_set_line(const char* data, int size)
+	{
+		if (size > 0 && data[size - 1] == '\r')
+		{
+			--size;
+		}
+		this->line = data;
+		this->size = size;
+	}
+
 }
@@ -0,0 +1,75 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+
+#include "hcondition.h"
+#include "hsemaphore.h"
+
+namespace hltypes
+{
+	Semaphore::Semaphore(int count)
+	{
+		this->count = count;
+	}
+
+	Semaphore::~Semaphore()
+	{
+	}
+
+	int Semaphore::getCount()
+	{
+		this->condition.lock();
+		int result = this->count;
+		this->condition.unlock();
+		return result;
+	}
+
+	bool Semaphore::acquire(float timeout)
+	{
+		this->condition.lock();
+		while (this->count <= 0)
+		{
+			if (!this->condition.wait(timeout) && this->count <= 0)
+			{
+				this->condition.unlock();
+				return false;
+			}
+		}
+		--this->count;
+		this->condition.unlock();
+		return true;
+	}
+
+	bool Semaphore::try_acquire()
+	{
+		this->condition.lock();
+		bool result = (this->count > 0);
+		if (result)
+		{
+			--this->count;
+		}
+		this->condition.unlock();
+		return result;
+	}
+
+	void Semaphore::release(int count)
+	{
+		this->condition.lock();
+		this->count += count;
+		if (count == 1)
+		{
+			this->condition.signal();
+		}
+		else
+		{
+			this->condition.broadcast();
+		}
+		this->condition.unlock();
+	}
+
+}
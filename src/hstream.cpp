@@ -130,4 +130,10 @@ namespace hltypes
 		}
 	}
 	
+	const unsigned char* Stream::_direct_data(long& size)
+	{
+		size = this->stream_size - this->stream_position;
+		return &this->stream[this->stream_position];
+	}
+	
 }
@@ -479,6 +479,106 @@ namespace hltypes
 		return String((const char*)&str[start_size], i - start_size);
 	}
 	
+	// hashing functions based on wyhash final4 with its default secrets
+
+#define HASH_SECRET0 0x2D358DCCAA6C78A5ULL
+#define HASH_SECRET1 0x8BB84B93962EACC9ULL
+#define HASH_SECRET2 0x4B33A62ED433D4A3ULL
+#define HASH_SECRET3 0x4D5A2DA51DE1AA47ULL
+
+	static inline void _hash_multiply(unsigned long long& a, unsigned long long& b)
+	{
+#if defined(__SIZEOF_INT128__)
+		__uint128_t product = (__uint128_t)a * b;
+		a = (unsigned long long)product;
+		b = (unsigned long long)(product >> 64);
+#else
+		// 64x64 to 128 bit multiplication done with 32-bit halves
+		unsigned long long aLow = a & 0xFFFFFFFF;
+		unsigned long long aHigh = a >> 32;
+		unsigned long long bLow = b & 0xFFFFFFFF;
+		unsigned long long bHigh = b >> 32;
+		unsigned long long low = aLow * bLow;
+		unsigned long long middle1 = aHigh * bLow;
+		unsigned long long middle2 = aLow * bHigh;
+		unsigned long long high = aHigh * bHigh;
+		unsigned long long carry = ((low >> 32) + (middle1 & 0xFFFFFFFF) + (middle2 & 0xFFFFFFFF)) >> 32;
+		a = low + (middle1 << 32) + (middle2 << 32);
+		b = high + (middle1 >> 32) + (middle2 >> 32) + carry;
+#endif
+	}
+
+	static inline unsigned long long _hash_mix(unsigned long long a, unsigned long long b)
+	{
+		_hash_multiply(a, b);
+		return (a ^ b);
+	}
+
+	static inline unsigned long long _hash_read8(const unsigned char* data)
+	{
+		return ((unsigned long long)data[0] | ((unsigned long long)data[1] << 8) | ((unsigned long long)data[2] << 16) |
+			((unsigned long long)data[3] << 24) | ((unsigned long long)data[4] << 32) | ((unsigned long long)data[5] << 40) |
+			((unsigned long long)data[6] << 48) | ((unsigned long long)data[7] << 56));
+	}
+
+	static inline unsigned long long _hash_read4(const unsigned char* data)
+	{
+		return ((unsigned long long)data[0] | ((unsigned long long)data[1] << 8) | ((unsigned long long)data[2] << 16) |
+			((unsigned long long)data[3] << 24));
+	}
+
+	unsigned long long String::hash(unsigned long long seed) const
+	{
+		const unsigned char* data = (const unsigned char*)stdstr::data();
+		unsigned long long size = (unsigned long long)stdstr::size();
+		unsigned long long a = 0;
+		unsigned long long b = 0;
+		seed ^= _hash_mix(seed ^ HASH_SECRET0, HASH_SECRET1);
+		if (size <= 16)
+		{
+			if (size >= 4)
+			{
+				unsigned long long offset = (size >> 3) << 2;
+				a = (_hash_read4(data) << 32) | _hash_read4(data + offset);
+				b = (_hash_read4(data + size - 4) << 32) | _hash_read4(data + size - 4 - offset);
+			}
+			else if (size > 0)
+			{
+				a = ((unsigned long long)data[0] << 16) | ((unsigned long long)data[size >> 1] << 8) | data[size - 1];
+			}
+		}
+		else
+		{
+			unsigned long long remaining = size;
+			if (remaining > 48)
+			{
+				unsigned long long seed1 = seed;
+				unsigned long long seed2 = seed;
+				do
+				{
+					seed = _hash_mix(_hash_read8(data) ^ HASH_SECRET1, _hash_read8(data + 8) ^ seed);
+					seed1 = _hash_mix(_hash_read8(data + 16) ^ HASH_SECRET2, _hash_read8(data + 24) ^ seed1);
+					seed2 = _hash_mix(_hash_read8(data + 32) ^ HASH_SECRET3, _hash_read8(data + 40) ^ seed2);
+					data += 48;
+					remaining -= 48;
+				} while (remaining > 48);
+				seed ^= seed1 ^ seed2;
+			}
+			while (remaining > 16)
+			{
+				seed = _hash_mix(_hash_read8(data) ^ HASH_SECRET1, _hash_read8(data + 8) ^ seed);
+				data += 16;
+				remaining -= 16;
+			}
+			a = _hash_read8(data + remaining - 16);
+			b = _hash_read8(data + remaining - 8);
+		}
+		a ^= HASH_SECRET1;
+		b ^= seed;
+		_hash_multiply(a, b);
+		return _hash_mix(a ^ HASH_SECRET0 ^ size, b ^ HASH_SECRET1);
+	}
+
 	int String::size() const
 	{
 		return (int)stdstr::size();
@@ -0,0 +1,304 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "harray.h"
+#include "hdeque.h"
+#include "hltypesUtil.h"
+#include "hmutex.h"
+#include "hplatform.h"
+#include "hthread.h"
+#include "hthreadpool.h"
+
+namespace hltypes
+{
+	/// @brief A worker thread of a ThreadPool with its own task queue.
+	class ThreadPoolWorker : public Thread
+	{
+	public:
+		ThreadPoolWorker(ThreadPool* pool, int index) : Thread(NULL), pool(pool), index(index), submitted(0), finished(0)
+		{
+		}
+
+		void execute();
+
+		ThreadPool* pool;
+		int index;
+		/// @brief Guards queue, submitted and finished.
+		Mutex mutex;
+		Deque<Task*> queue;
+		/// @brief Number of tasks that were queued on this worker.
+		int submitted;
+		/// @brief Number of tasks that were executed by this worker.
+		int finished;
+
+	};
+
+	// the worker that runs on the current thread, NULL on threads that don't belong to a ThreadPool
+	static _HL_THREAD_LOCAL ThreadPoolWorker* currentWorker = NULL;
+
+	void ThreadPoolWorker::execute()
+	{
+		currentWorker = this;
+		Task* task = this->pool->_take_task(this->index, true);
+		while (task != NULL)
+		{
+			this->pool->_execute_task(this->index, task);
+			task = this->pool->_take_task(this->index, true);
+		}
+		currentWorker = NULL;
+	}
+
+	Task::Task(void (*function)(void*), void* argument) : pool(NULL), done(false)
+	{
+		this->function = function;
+		this->argument = argument;
+	}
+
+	Task::~Task()
+	{
+	}
+
+	bool Task::isDone()
+	{
+		this->condition.lock();
+		bool result = this->done;
+		this->condition.unlock();
+		return result;
+	}
+
+	void Task::wait()
+	{
+		this->condition.lock();
+		ThreadPool* pool = this->pool;
+		this->condition.unlock();
+		ThreadPoolWorker* worker = currentWorker;
+		if (worker != NULL && worker->pool == pool)
+		{
+			// blocking here could leave no worker to execute the task so this worker helps out instead
+			Task* task = NULL;
+			while (!this->isDone())
+			{
+				task = pool->_take_task(worker->index, false);
+				if (task == NULL)
+				{
+					// no queues contain tasks anymore so the task is already being executed by another worker
+					break;
+				}
+				pool->_execute_task(worker->index, task);
+			}
+		}
+		this->condition.lock();
+		while (!this->done)
+		{
+			this->condition.wait();
+		}
+		this->condition.unlock();
+	}
+
+	void Task::execute()
+	{
+		if (this->function != NULL)
+		{
+			(*this->function)(this->argument);
+		}
+	}
+
+	void Task::_run()
+	{
+		this->execute();
+		this->condition.lock();
+		this->done = true;
+		this->condition.broadcast();
+		this->condition.unlock();
+	}
+
+	ThreadPool::ThreadPool(int count) : next_worker(0), sleeping(0), stopping(false), waiting(0)
+	{
+		if (count <= 0)
+		{
+			count = ThreadPool::getCpuCount();
+		}
+		for_iter (i, 0, count)
+		{
+			this->workers += new ThreadPoolWorker(this, i);
+		}
+		foreach (ThreadPoolWorker*, it, this->workers)
+		{
+			(*it)->start();
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		this->wait();
+		this->work_condition.lock();
+		this->stopping = true;
+		this->work_condition.broadcast();
+		this->work_condition.unlock();
+		foreach (ThreadPoolWorker*, it, this->workers)
+		{
+			(*it)->join();
+			delete (*it);
+		}
+		this->workers.clear();
+	}
+
+	Task* ThreadPool::submit(Task* task)
+	{
+		task->condition.lock();
+		task->pool = this;
+		task->done = false;
+		task->condition.unlock();
+		// tasks submitted by a worker stay on that worker so they are most likely executed by it while its data is still cached
+		ThreadPoolWorker* worker = currentWorker;
+		if (worker == NULL || worker->pool != this)
+		{
+			this->submit_mutex.lock();
+			worker = this->workers[this->next_worker];
+			this->next_worker = (this->next_worker + 1) % this->workers.size();
+			this->submit_mutex.unlock();
+		}
+		worker->mutex.lock();
+		worker->queue.push_back(task);
+		++worker->submitted;
+		worker->mutex.unlock();
+		// a sleeping worker increases the counter before it checks the queues again so it can't miss this task
+		if (this->sleeping > 0)
+		{
+			this->work_condition.lock();
+			this->work_condition.signal();
+			this->work_condition.unlock();
+		}
+		return task;
+	}
+
+	Task* ThreadPool::submit(void (*function)(void*), void* argument)
+	{
+		return this->submit(new Task(function, argument));
+	}
+
+	void ThreadPool::wait()
+	{
+		this->done_condition.lock();
+		++this->waiting;
+		while (this->_count_pending() > 0)
+		{
+			this->done_condition.wait();
+		}
+		--this->waiting;
+		this->done_condition.unlock();
+	}
+
+	Task* ThreadPool::_take_task(int index, bool blocking)
+	{
+		Task* task = this->_find_task(index);
+		if (task != NULL || !blocking)
+		{
+			return task;
+		}
+		this->work_condition.lock();
+		++this->sleeping;
+		while (!this->stopping)
+		{
+			// checked again after announcing that this worker sleeps so a task submitted in the meantime isn't missed
+			task = this->_find_task(index);
+			if (task != NULL)
+			{
+				break;
+			}
+			this->work_condition.wait();
+		}
+		--this->sleeping;
+		this->work_condition.unlock();
+		return task;
+	}
+
+	Task* ThreadPool::_find_task(int index)
+	{
+		Task* task = NULL;
+		ThreadPoolWorker* worker = NULL;
+		int size = this->workers.size();
+		// the own queue is used like a stack, other queues are stolen from at the other end so the oldest and usually
+		// largest tasks are stolen, stealing starts at the next worker so not all idle workers steal from the same queue
+		for_iter (i, 0, size)
+		{
+			worker = this->workers[(index + i) % size];
+			worker->mutex.lock();
+			if (worker->queue.size() > 0)
+			{
+				task = (i == 0 ? worker->queue.pop_back() : worker->queue.pop_front());
+			}
+			worker->mutex.unlock();
+			if (task != NULL)
+			{
+				break;
+			}
+		}
+		return task;
+	}
+
+	void ThreadPool::_execute_task(int index, Task* task)
+	{
+		task->_run();
+		ThreadPoolWorker* worker = this->workers[index];
+		worker->mutex.lock();
+		++worker->finished;
+		worker->mutex.unlock();
+		// a waiting thread increases the counter before it counts the finished tasks so it can't miss this one
+		if (this->waiting > 0)
+		{
+			this->done_condition.lock();
+			this->done_condition.broadcast();
+			this->done_condition.unlock();
+		}
+	}
+
+	int ThreadPool::_count_pending()
+	{
+		// all finished tasks are counted before all submitted tasks, every counted finished task was submitted before
+		// so the result can only be too high while tasks are being submitted, but never too low
+		int finished = 0;
+		foreach (ThreadPoolWorker*, it, this->workers)
+		{
+			(*it)->mutex.lock();
+			finished += (*it)->finished;
+			(*it)->mutex.unlock();
+		}
+		int submitted = 0;
+		foreach (ThreadPoolWorker*, it, this->workers)
+		{
+			(*it)->mutex.lock();
+			submitted += (*it)->submitted;
+			(*it)->mutex.unlock();
+		}
+		return (submitted - finished);
+	}
+
+	int ThreadPool::getCpuCount()
+	{
+		int result = 1;
+#ifdef _WIN32
+		SYSTEM_INFO info;
+#ifndef _WINRT
+		GetSystemInfo(&info);
+#else
+		GetNativeSystemInfo(&info);
+#endif
+		result = (int)info.dwNumberOfProcessors;
+#else
+		result = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+		return hmax(result, 1);
+	}
+
+}
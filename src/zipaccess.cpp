@@ -9,140 +9,936 @@
 
 #ifdef _ZIPRESOURCE
 #include <stdio.h>
+#include <string.h>
 #include <zip.h>
+#include <zlib.h>
 
 #include "harray.h"
-#include "hmap.h"
+#include "hhashmap.h"
 #include "hmutex.h"
+#include "hparallel.h"
 #include "hrdir.h"
 #include "hresource.h"
+#include "hrwmutex.h"
 #include "hstring.h"
+#include "hthreadpool.h"
+#include "zipaccess.h"
+
+#define MAX_IDLE_HANDLES 8
+#define INPUT_BUFFER_SIZE 16384
+#define WINDOW_SIZE 32768
+#define CHECKPOINT_SPAN 1048576
+// zip_fseek() is available since libzip 1.2
+#if defined(LIBZIP_VERSION_MAJOR) && (LIBZIP_VERSION_MAJOR > 1 || (LIBZIP_VERSION_MAJOR == 1 && LIBZIP_VERSION_MINOR >= 2))
+#define _ZIP_FSEEK
+#endif
 
 namespace hltypes
 {
 	namespace zip
 	{
-		static Mutex access_mutex;
-		static Map<void*, Array<Resource*> > activeHandles;
-		static void* currentArchive = NULL;
+		/// @brief Metadata of a file in the archive.
+		struct ArchiveEntry
+		{
+			int index;
+			unsigned long size;
+			unsigned long modification_time;
+			int compression_method;
+			int encryption_method;
 
-		void setArchive(const String& value)
+			ArchiveEntry() : index(-1), size(0), modification_time(0), compression_method(ZIP_CM_STORE), encryption_method(ZIP_EM_NONE)
+			{
+			}
+
+		};
+
+		/// @brief Inflate state at the end of a deflate block that can be resumed from later.
+		struct Checkpoint
+		{
+			long output_position;
+			long input_position;
+			int bits;
+			unsigned char* window;
+
+		};
+
+		/// @brief How the data of an opened entry is read.
+		enum ReadMode
+		{
+			READ_STORED, // the raw data is the file data
+			READ_INFLATE, // the raw data is inflated here so seeking can resume from checkpoints
+			READ_STREAM, // libzip handles decompression, seeking has to start over
+			READ_CACHED // the data is read from the cache
+		};
+
+		/// @brief Decompressed data of a file that is kept in memory.
+		struct CacheEntry
+		{
+			unsigned char* data;
+			long size;
+			int references;
+			unsigned long last_access;
+			bool cached;
+
+		};
+
+		/// @brief An opened file in the archive.
+		struct ArchiveFile
+		{
+			struct zip* archive;
+			struct zip_file* file;
+			ArchiveEntry entry;
+			ReadMode mode;
+			long input_position;
+			long output_position;
+			bool finished;
+			z_stream stream;
+			unsigned char* input;
+			unsigned char* window;
+			int window_position;
+			Array<Checkpoint> checkpoints;
+			CacheEntry* cache_entry;
+
+		};
+
+		/// @brief Contents of a directory in the archive.
+		struct ArchiveDirectory
+		{
+			Array<String> directories;
+			Array<String> files;
+
+		};
+
+		// every open Resource exclusively owns one archive handle so reading and decompression can run in parallel
+		static Mutex handles_mutex("hltypes::zip::handles_mutex");
+		static Array<void*> currentHandles;
+		static Array<void*> idleHandles;
+		static int generation = 0;
+		// the central directory is indexed once so lookups don't have to go through all archive entries
+		static ReadWriteMutex index_mutex;
+		static bool indexed = false;
+		static HashMap<String, ArchiveEntry> indexEntries;
+		static HashMap<String, ArchiveDirectory> indexDirectories;
+		static HashMap<String, String> indexLowerEntries;
+		static HashMap<String, String> indexLowerDirectories;
+		// decompressed files are kept in memory so repeated loads don't have to inflate them again
+		static Mutex cache_mutex("hltypes::zip::cache_mutex");
+		static HashMap<String, CacheEntry*> cacheEntries;
+		static long cacheSize = 0;
+		static long cacheUsage = 0;
+		static unsigned long cacheTime = 0;
+
+		static String _make_key(const String& path)
+		{
+			String result = ResourceDir::systemize(path);
+			if (result.starts_with("./"))
+			{
+				result = result(2, result.size() - 2);
+			}
+			if (result.ends_with("/"))
+			{
+				result = result(0, result.size() - 1);
+			}
+			return (result != "." ? result : "");
+		}
+
+		static void _split_key(const String& key, String& parent, String& basename)
+		{
+			int index = key.rfind('/');
+			parent = (index >= 0 ? key(0, index) : String(""));
+			basename = (index >= 0 ? key(index + 1, key.size() - index - 1) : key);
+		}
+
+		static void _index_directory(const String& key)
+		{
+			if (indexDirectories.has_key(key))
+			{
+				return;
+			}
+			indexDirectories[key] = ArchiveDirectory();
+			indexLowerDirectories[key.lower()] = key;
+			String parent;
+			String basename;
+			_split_key(key, parent, basename);
+			_index_directory(parent);
+			indexDirectories[parent].directories += basename;
+		}
+
+		static void _index_file(const String& key, const ArchiveEntry& entry)
 		{
-			if (currentArchive != NULL && activeHandles[currentArchive].size() == 0)
+			if (indexEntries.has_key(key))
 			{
-				zip_close((struct zip*)currentArchive);
-				activeHandles.remove_key(currentArchive);
-				currentArchive = NULL;
+				return;
 			}
-			Array<void*> handles = activeHandles.keys();
+			indexEntries[key] = entry;
+			indexLowerEntries[key.lower()] = key;
+			String parent;
+			String basename;
+			_split_key(key, parent, basename);
+			_index_directory(parent);
+			indexDirectories[parent].files += basename;
+		}
+
+		static void _build_index(void* archivefile)
+		{
+			indexEntries.clear();
+			indexDirectories.clear();
+			indexLowerEntries.clear();
+			indexLowerDirectories.clear();
+			indexDirectories[""] = ArchiveDirectory();
+			indexed = (archivefile != NULL);
+			if (archivefile == NULL)
+			{
+				return;
+			}
+			struct zip* archive = (struct zip*)archivefile;
+			int count = zip_get_num_files(archive);
+			struct zip_stat stat;
+			String name;
+			String key;
+			ArchiveEntry entry;
+			for_iter (i, 0, count)
+			{
+				if (zip_stat_index(archive, i, 0, &stat) != 0 || stat.name == NULL)
+				{
+					continue;
+				}
+				name = ResourceDir::systemize(String(stat.name));
+				key = _make_key(name);
+				if (key == "")
+				{
+					continue;
+				}
+				if (name.ends_with("/"))
+				{
+					_index_directory(key);
+				}
+				else
+				{
+					entry.index = i;
+					entry.size = (unsigned long)stat.size;
+					entry.modification_time = (unsigned long)stat.mtime;
+					entry.compression_method = stat.comp_method;
+					entry.encryption_method = stat.encryption_method;
+					_index_file(key, entry);
+				}
+			}
+		}
+
+		static void _lock_index()
+		{
+			index_mutex.lock_read();
+			if (indexed)
+			{
+				return;
+			}
+			// the archive may not have been available when it was set so indexing is attempted again
+			index_mutex.unlock_read();
+			index_mutex.lock_write();
+			if (!indexed && Resource::getArchive() != "")
+			{
+				struct zip* archive = zip_open(Resource::getArchive().c_str(), 0, NULL);
+				if (archive != NULL)
+				{
+					_build_index(archive);
+					zip_close(archive);
+				}
+			}
+			index_mutex.unlock_write();
+			index_mutex.lock_read();
+		}
+
+		static void _release_cache_entry(CacheEntry* cacheEntry)
+		{
+			--cacheEntry->references;
+			if (cacheEntry->references <= 0 && !cacheEntry->cached)
+			{
+				delete [] cacheEntry->data;
+				delete cacheEntry;
+			}
+		}
+
+		static void _remove_cache_entry(const String& key)
+		{
+			CacheEntry* cacheEntry = cacheEntries[key];
+			cacheEntries.remove_key(key);
+			cacheUsage -= cacheEntry->size;
+			cacheEntry->cached = false;
+			// entries still used by open files are deleted when they are closed
+			++cacheEntry->references;
+			_release_cache_entry(cacheEntry);
+		}
+
+		static void _trim_cache(long size)
+		{
+			String key;
+			unsigned long last_access = 0;
+			while (cacheEntries.size() > 0 && cacheUsage + size > cacheSize)
+			{
+				// the least recently used entry is removed
+				key = "";
+				foreach_hm (CacheEntry*, it, cacheEntries)
+				{
+					if (key == "" || it->second->last_access < last_access)
+					{
+						key = it->first;
+						last_access = it->second->last_access;
+					}
+				}
+				_remove_cache_entry(key);
+			}
+		}
+
+		static CacheEntry* _acquire_cache_entry(const String& key)
+		{
+			CacheEntry* cacheEntry = NULL;
+			cache_mutex.lock();
+			if (cacheEntries.has_key(key))
+			{
+				cacheEntry = cacheEntries[key];
+				++cacheEntry->references;
+				cacheEntry->last_access = ++cacheTime;
+			}
+			cache_mutex.unlock();
+			return cacheEntry;
+		}
+
+		static void _clear_cache()
+		{
+			cache_mutex.lock();
+			Array<String> keys = cacheEntries.keys();
+			foreach (String, it, keys)
+			{
+				_remove_cache_entry(*it);
+			}
+			cache_mutex.unlock();
+		}
+
+		void setArchive(const String& value)
+		{
+			_clear_cache();
+			handles_mutex.lock();
+			Array<void*> handles = idleHandles;
+			idleHandles.clear();
+			// handles that are still in use are closed when their Resource is closed
+			currentHandles.clear();
+			++generation;
+			handles_mutex.unlock();
 			foreach (void*, it, handles)
 			{
-				if (activeHandles[*it].size() == 0)
+				zip_close((struct zip*)(*it));
+			}
+			void* archivefile = (value != "" ? zip_open(value.c_str(), 0, NULL) : NULL);
+			index_mutex.lock_write();
+			_build_index(archivefile);
+			index_mutex.unlock_write();
+			if (archivefile != NULL)
+			{
+				// the handle used for indexing can be reused right away
+				handles_mutex.lock();
+				currentHandles += archivefile;
+				idleHandles += archivefile;
+				handles_mutex.unlock();
+			}
+		}
+
+		void* open(Resource* /*resource*/)
+		{
+			handles_mutex.lock();
+			if (idleHandles.size() > 0)
+			{
+				void* archivefile = idleHandles.pop_last();
+				handles_mutex.unlock();
+				return archivefile;
+			}
+			int current_generation = generation;
+			handles_mutex.unlock();
+			String archive = Resource::getArchive();
+			if (archive == "")
+			{
+				return NULL;
+			}
+			// opening reads the central directory so it's done outside of the lock
+			void* archivefile = zip_open(archive.c_str(), 0, NULL);
+			if (archivefile == NULL)
+			{
+				return NULL;
+			}
+			handles_mutex.lock();
+			if (current_generation == generation)
+			{
+				currentHandles += archivefile;
+			}
+			handles_mutex.unlock();
+			return archivefile;
+		}
+
+		void close(Resource* /*resource*/, void* archive)
+		{
+			handles_mutex.lock();
+			if (currentHandles.contains(archive))
+			{
+				if (idleHandles.size() < MAX_IDLE_HANDLES)
 				{
-					zip_close((struct zip*)(*it));
-					activeHandles.remove_key((*it));
+					idleHandles += archive;
+					handles_mutex.unlock();
+					return;
 				}
+				currentHandles.remove(archive);
 			}
+			handles_mutex.unlock();
+			zip_close((struct zip*)archive);
 		}
 
-		void* open(Resource* resource)
+		static bool _reopen_file(ArchiveFile* file)
 		{
-			if (currentArchive == NULL)
+			if (file->file != NULL)
 			{
-				String archive = Resource::getArchive();
-				if (archive == "")
+				zip_fclose(file->file);
+			}
+			file->file = zip_fopen_index(file->archive, file->entry.index, (file->mode != READ_STREAM ? ZIP_FL_COMPRESSED : 0));
+			file->input_position = 0;
+			file->output_position = 0;
+			file->finished = false;
+			if (file->mode == READ_INFLATE)
+			{
+				inflateReset(&file->stream);
+				file->stream.avail_in = 0;
+				file->window_position = 0;
+			}
+			return (file->file != NULL);
+		}
+
+		static bool _skip_input(ArchiveFile* file, long count)
+		{
+			long read = 0;
+			while (count > 0)
+			{
+				read = zip_fread(file->file, file->input, hmin(count, (long)INPUT_BUFFER_SIZE));
+				if (read <= 0)
 				{
-					return NULL;
+					return false;
 				}
-				currentArchive = zip_open(archive.c_str(), 0, NULL);
-				if (currentArchive == NULL)
+				file->input_position += read;
+				count -= read;
+			}
+			return true;
+		}
+
+		static void _add_checkpoint(ArchiveFile* file)
+		{
+			Checkpoint checkpoint;
+			checkpoint.output_position = file->output_position;
+			checkpoint.input_position = file->input_position - file->stream.avail_in;
+			checkpoint.bits = file->stream.data_type & 7;
+			// the window is stored starting with the oldest byte
+			checkpoint.window = new unsigned char[WINDOW_SIZE];
+			int size = WINDOW_SIZE - file->window_position;
+			memcpy(checkpoint.window, &file->window[file->window_position], size);
+			memcpy(&checkpoint.window[size], file->window, file->window_position);
+			file->checkpoints += checkpoint;
+		}
+
+		static bool _restore_checkpoint(ArchiveFile* file, const Checkpoint& checkpoint)
+		{
+			if (!_reopen_file(file))
+			{
+				return false;
+			}
+			// a deflate block can end in the middle of a byte
+			if (!_skip_input(file, checkpoint.input_position - (checkpoint.bits > 0 ? 1 : 0)))
+			{
+				return false;
+			}
+			if (checkpoint.bits > 0)
+			{
+				unsigned char value = 0;
+				if (zip_fread(file->file, &value, 1) != 1)
 				{
-					return NULL;
+					return false;
 				}
-				activeHandles[currentArchive] = Array<Resource*>();
+				++file->input_position;
+				inflatePrime(&file->stream, checkpoint.bits, value >> (8 - checkpoint.bits));
 			}
-			activeHandles[currentArchive] += resource;
-			return currentArchive;
+			inflateSetDictionary(&file->stream, checkpoint.window, WINDOW_SIZE);
+			memcpy(file->window, checkpoint.window, WINDOW_SIZE);
+			file->window_position = 0;
+			file->output_position = checkpoint.output_position;
+			return true;
 		}
 
-		void close(Resource* resource, void* archive)
+		static long _inflate(ArchiveFile* file, unsigned char* buffer, long count)
 		{
-			Array<Resource*> references = activeHandles[archive];
-			references -= resource;
-			activeHandles[archive] = references;
-			if (currentArchive != archive && references.size() == 0)
+			long result = 0;
+			long read = 0;
+			int size = 0;
+			int error = Z_OK;
+			bool inputEnd = false;
+			while (result < count && !file->finished)
 			{
-				zip_close((struct zip*)archive);
-				activeHandles.remove_key(archive);
+				if (file->stream.avail_in == 0 && !inputEnd)
+				{
+					read = zip_fread(file->file, file->input, INPUT_BUFFER_SIZE);
+					if (read < 0)
+					{
+						break;
+					}
+					// inflate can still have pending output after all input was consumed
+					inputEnd = (read == 0);
+					file->input_position += read;
+					file->stream.next_in = file->input;
+					file->stream.avail_in = (uInt)read;
+				}
+				// data is always inflated into the window first, because the window is needed for checkpoints
+				size = (int)hmin((long)(WINDOW_SIZE - file->window_position), count - result);
+				file->stream.next_out = &file->window[file->window_position];
+				file->stream.avail_out = size;
+				error = inflate(&file->stream, Z_BLOCK);
+				size -= file->stream.avail_out;
+				if (buffer != NULL && size > 0)
+				{
+					memcpy(&buffer[result], &file->window[file->window_position], size);
+				}
+				file->window_position = (file->window_position + size) % WINDOW_SIZE;
+				file->output_position += size;
+				result += size;
+				if (error == Z_STREAM_END)
+				{
+					file->finished = true;
+				}
+				else if (error != Z_OK && (error != Z_BUF_ERROR || (inputEnd && size == 0)))
+				{
+					break;
+				}
+				// the inflate state can only be restored at the end of a block that isn't the last one
+				if ((file->stream.data_type & 128) != 0 && (file->stream.data_type & 64) == 0 &&
+					file->output_position - (file->checkpoints.size() > 0 ? file->checkpoints.last().output_position : 0) >= CHECKPOINT_SPAN)
+				{
+					_add_checkpoint(file);
+				}
+			}
+			return result;
+		}
+
+		static long _read_file(ArchiveFile* file, unsigned char* buffer, long count)
+		{
+			if (file->mode == READ_CACHED)
+			{
+				count = hmin(count, file->cache_entry->size - file->output_position);
+				if (buffer != NULL && count > 0)
+				{
+					memcpy(buffer, &file->cache_entry->data[file->output_position], count);
+				}
+				file->output_position += hmax(count, 0L);
+				return hmax(count, 0L);
+			}
+			if (file->mode == READ_INFLATE)
+			{
+				return _inflate(file, buffer, count);
+			}
+			if (buffer != NULL)
+			{
+				long read = zip_fread(file->file, buffer, count);
+				if (read > 0)
+				{
+					file->output_position += read;
+				}
+				return hmax(read, 0L);
+			}
+			// discarded data is read in chunks so the buffer stays small, it's only allocated once it's needed
+			if (file->input == NULL)
+			{
+				file->input = new unsigned char[INPUT_BUFFER_SIZE];
+			}
+			long result = 0;
+			long read = 0;
+			while (result < count)
+			{
+				read = zip_fread(file->file, file->input, hmin(count - result, (long)INPUT_BUFFER_SIZE));
+				if (read <= 0)
+				{
+					break;
+				}
+				file->output_position += read;
+				result += read;
+			}
+			return result;
+		}
+
+		static ArchiveFile* _open_file(void* archivefile, const ArchiveEntry& entry)
+		{
+			ArchiveFile* file = new ArchiveFile();
+			file->archive = (struct zip*)archivefile;
+			file->file = NULL;
+			file->entry = entry;
+			file->mode = READ_STREAM;
+			file->cache_entry = NULL;
+			if (entry.encryption_method == ZIP_EM_NONE)
+			{
+				if (entry.compression_method == ZIP_CM_STORE)
+				{
+					file->mode = READ_STORED;
+				}
+				else if (entry.compression_method == ZIP_CM_DEFLATE)
+				{
+					file->mode = READ_INFLATE;
+				}
+			}
+			file->input = NULL;
+			file->window = NULL;
+			if (file->mode == READ_INFLATE)
+			{
+				memset(&file->stream, 0, sizeof(z_stream));
+				// negative window bits, because zip entries contain raw deflate data
+				if (inflateInit2(&file->stream, -MAX_WBITS) != Z_OK)
+				{
+					file->mode = READ_STREAM;
+				}
+				else
+				{
+					file->input = new unsigned char[INPUT_BUFFER_SIZE];
+					file->window = new unsigned char[WINDOW_SIZE];
+					memset(file->window, 0, WINDOW_SIZE);
+				}
+			}
+			if (!_reopen_file(file))
+			{
+				zip::fclose(file);
+				return NULL;
+			}
+			return file;
+		}
+
+		static CacheEntry* _load_cache_entry(void* archivefile, const String& key, const ArchiveEntry& entry)
+		{
+			ArchiveFile* file = _open_file(archivefile, entry);
+			if (file == NULL)
+			{
+				return NULL;
+			}
+			unsigned char* data = new unsigned char[hmax(entry.size, 1UL)];
+			long size = _read_file(file, data, entry.size);
+			zip::fclose(file);
+			if (size != (long)entry.size)
+			{
+				delete [] data;
+				return NULL;
+			}
+			cache_mutex.lock();
+			CacheEntry* cacheEntry = NULL;
+			if (cacheEntries.has_key(key)) // another thread could have loaded it in the meantime
+			{
+				cacheEntry = cacheEntries[key];
+				delete [] data;
+			}
+			else if (size <= cacheSize)
+			{
+				_trim_cache(size);
+				cacheEntry = new CacheEntry();
+				cacheEntry->data = data;
+				cacheEntry->size = size;
+				cacheEntry->references = 0;
+				cacheEntry->cached = true;
+				cacheEntries[key] = cacheEntry;
+				cacheUsage += size;
+			}
+			else
+			{
+				delete [] data;
+			}
+			if (cacheEntry != NULL)
+			{
+				++cacheEntry->references;
+				cacheEntry->last_access = ++cacheTime;
+			}
+			cache_mutex.unlock();
+			return cacheEntry;
+		}
+
+		static bool _find_entry(const String& key, ArchiveEntry& entry)
+		{
+			_lock_index();
+			bool result = indexEntries.has_key(key);
+			if (result)
+			{
+				entry = indexEntries[key];
+			}
+			index_mutex.unlock_read();
+			return result;
+		}
+
+		static void _preload_file(void* argument)
+		{
+			String key = *(String*)argument;
+			ArchiveEntry entry;
+			if (!_find_entry(key, entry))
+			{
+				return;
+			}
+			CacheEntry* cacheEntry = _acquire_cache_entry(key);
+			if (cacheEntry == NULL)
+			{
+				void* archivefile = zip::open(NULL);
+				if (archivefile == NULL)
+				{
+					return;
+				}
+				cacheEntry = _load_cache_entry(archivefile, key, entry);
+				zip::close(NULL, archivefile);
+			}
+			if (cacheEntry != NULL)
+			{
+				cache_mutex.lock();
+				_release_cache_entry(cacheEntry);
+				cache_mutex.unlock();
 			}
 		}
 
 		void* fopen(void* archivefile, const String& filename)
 		{
-			access_mutex.lock();
-			void* file = zip_fopen((struct zip*)archivefile, filename.c_str(), 0);
-			access_mutex.unlock();
+			String key = _make_key(filename);
+			ArchiveEntry entry;
+			if (!_find_entry(key, entry))
+			{
+				return NULL;
+			}
+			CacheEntry* cacheEntry = _acquire_cache_entry(key);
+			cache_mutex.lock();
+			// a single large file shouldn't be able to flush the whole cache
+			bool cacheable = (cacheSize > 0 && entry.size <= (unsigned long)(cacheSize / 4));
+			cache_mutex.unlock();
+			if (cacheEntry == NULL && cacheable)
+			{
+				cacheEntry = _load_cache_entry(archivefile, key, entry);
+			}
+			if (cacheEntry == NULL)
+			{
+				return _open_file(archivefile, entry);
+			}
+			ArchiveFile* file = new ArchiveFile();
+			file->archive = (struct zip*)archivefile;
+			file->file = NULL;
+			file->entry = entry;
+			file->mode = READ_CACHED;
+			file->output_position = 0;
+			file->finished = false;
+			file->input = NULL;
+			file->window = NULL;
+			file->cache_entry = cacheEntry;
 			return file;
 		}
 
 		void fclose(void* file)
 		{
-			access_mutex.lock();
-			zip_fclose((struct zip_file*)file);
-			access_mutex.unlock();
+			ArchiveFile* archiveFile = (ArchiveFile*)file;
+			if (archiveFile->file != NULL)
+			{
+				zip_fclose(archiveFile->file);
+			}
+			if (archiveFile->mode == READ_INFLATE)
+			{
+				inflateEnd(&archiveFile->stream);
+			}
+			if (archiveFile->cache_entry != NULL)
+			{
+				cache_mutex.lock();
+				_release_cache_entry(archiveFile->cache_entry);
+				cache_mutex.unlock();
+			}
+			foreach (Checkpoint, it, archiveFile->checkpoints)
+			{
+				delete [] (*it).window;
+			}
+			delete [] archiveFile->window;
+			delete [] archiveFile->input;
+			delete archiveFile;
 		}
 
 		long fread(void* file, void* buffer, int count)
 		{
-			access_mutex.lock();
-			long result = zip_fread((struct zip_file*)file, buffer, count);
-			access_mutex.unlock();
+			return _read_file((ArchiveFile*)file, (unsigned char*)buffer, count);
+		}
+
+		long fseek(void* file, long position)
+		{
+			ArchiveFile* archiveFile = (ArchiveFile*)file;
+			position = hclamp(position, 0L, (long)archiveFile->entry.size);
+			if (archiveFile->mode == READ_CACHED)
+			{
+				archiveFile->output_position = position;
+				return position;
+			}
+#ifdef _ZIP_FSEEK
+			if (archiveFile->mode == READ_STORED && archiveFile->file != NULL)
+			{
+				// the raw data is the file data so the position can be seeked directly
+				if (zip_fseek(archiveFile->file, position, SEEK_SET) == 0)
+				{
+					archiveFile->output_position = position;
+					return position;
+				}
+			}
+#endif
+			if (archiveFile->mode == READ_INFLATE)
+			{
+				// the closest checkpoint is used if it's closer than the current position
+				Checkpoint* checkpoint = NULL;
+				foreach (Checkpoint, it, archiveFile->checkpoints)
+				{
+					if ((*it).output_position > position)
+					{
+						break;
+					}
+					checkpoint = &(*it);
+				}
+				if (checkpoint != NULL && (position < archiveFile->output_position || checkpoint->output_position > archiveFile->output_position))
+				{
+					if (!_restore_checkpoint(archiveFile, *checkpoint))
+					{
+						_reopen_file(archiveFile);
+					}
+				}
+			}
+			if (position < archiveFile->output_position)
+			{
+				_reopen_file(archiveFile);
+			}
+			if (archiveFile->file != NULL && position > archiveFile->output_position)
+			{
+				// the data has to be decompressed and discarded to get to the position
+				_read_file(archiveFile, NULL, position - archiveFile->output_position);
+			}
+			return archiveFile->output_position;
+		}
+
+		long fsize(const String& filename)
+		{
+			return (long)zip::finfo(filename).size;
+		}
+
+		FileInfo finfo(const String& filename)
+		{
+			FileInfo info;
+			String key = _make_key(filename);
+			_lock_index();
+			if (indexEntries.has_key(key))
+			{
+				ArchiveEntry& entry = indexEntries[key];
+				info.size = entry.size;
+				info.modification_time = entry.modification_time;
+			}
+			index_mutex.unlock_read();
+			return info;
+		}
+
+		bool exists(const String& filename, bool case_sensitive)
+		{
+			String key = _make_key(filename);
+			_lock_index();
+			bool result = (indexEntries.has_key(key) || (!case_sensitive && indexLowerEntries.has_key(key.lower())));
+			index_mutex.unlock_read();
 			return result;
 		}
 
-		long fsize(void* archivefile, const String& filename)
+		bool directoryExists(const String& dirname, bool case_sensitive)
 		{
-			struct zip_stat stat;
-			stat.size = 0;
-			access_mutex.lock();
-			zip_stat((struct zip*)archivefile, Resource::make_full_path(filename).c_str(), 0, &stat);
-			access_mutex.unlock();
-			return stat.size;
+			String key = _make_key(dirname);
+			_lock_index();
+			bool result = (indexDirectories.has_key(key) || (!case_sensitive && indexLowerDirectories.has_key(key.lower())));
+			index_mutex.unlock_read();
+			return result;
 		}
 
-		void* freopen(void* file, void* archivefile, const String& filename)
+		Array<String> getDirectories(const String& dirname)
 		{
-			access_mutex.lock();
-			zip_fclose((struct zip_file*)file);
-			file = zip_fopen((struct zip*)archivefile, filename.c_str(), 0);
-			access_mutex.unlock();
-			return file;
+			Array<String> result;
+			String key = _make_key(dirname);
+			_lock_index();
+			if (indexDirectories.has_key(key))
+			{
+				result = indexDirectories[key].directories;
+			}
+			index_mutex.unlock_read();
+			return result;
 		}
 
-		Array<String> getFiles(void* archivefile)
+		Array<String> getFiles(const String& dirname)
 		{
 			Array<String> result;
-			struct zip* archive = (struct zip*)archivefile;
-			int count = zip_get_num_files(archive);
-			for_iter (i, 0, count)
+			String key = _make_key(dirname);
+			_lock_index();
+			if (indexDirectories.has_key(key))
 			{
-				result += ResourceDir::systemize(String(zip_get_name(archive, i, 0)));
+				result = indexDirectories[key].files;
 			}
+			index_mutex.unlock_read();
 			return result;
 		}
 
-		FileInfo finfo(void* archivefile, const String& filename)
+		Array<String> getAllFiles()
 		{
-			struct zip_stat stat;
-			stat.size = 0;
-			stat.mtime = 0;
-			access_mutex.lock();
-			zip_stat((struct zip*)archivefile, Resource::make_full_path(filename).c_str(), 0, &stat);
-			access_mutex.unlock();
-			FileInfo info;
-			info.size = stat.size;
-			info.modification_time = stat.mtime;
-			return info;
+			_lock_index();
+			Array<String> result = indexEntries.keys();
+			index_mutex.unlock_read();
+			return result;
+		}
+
+		long getCacheSize()
+		{
+			cache_mutex.lock();
+			long result = cacheSize;
+			cache_mutex.unlock();
+			return result;
+		}
+
+		void setCacheSize(long value)
+		{
+			cache_mutex.lock();
+			cacheSize = hmax(value, 0L);
+			_trim_cache(0);
+			cache_mutex.unlock();
+		}
+
+		void clearCache()
+		{
+			_clear_cache();
+		}
+
+		void preload(const Array<String>& filenames)
+		{
+			if (getCacheSize() <= 0 || filenames.size() == 0)
+			{
+				return;
+			}
+			Array<String> keys;
+			foreachc (String, it, filenames)
+			{
+				keys += _make_key(*it);
+			}
+			// files are decompressed in parallel, every task uses its own archive handle
+			ThreadPool* pool = Parallel::getThreadPool();
+			Array<Task*> tasks;
+			if (pool != NULL)
+			{
+				for_iter (i, 1, keys.size())
+				{
+					tasks += pool->submit(&_preload_file, &keys[i]);
+				}
+			}
+			else
+			{
+				for_iter (i, 1, keys.size())
+				{
+					_preload_file(&keys[i]);
+				}
+			}
+			// the calling thread decompresses a file as well
+			_preload_file(&keys[0]);
+			foreach (Task*, it, tasks)
+			{
+				(*it)->wait();
+				delete (*it);
+			}
 		}
 
 	}
@@ -27,10 +27,18 @@ namespace hltypes
 		void* fopen(void* archivefile, const String& filename);
 		void fclose(void* file);
 		long fread(void* file, void* buffer, int count);
-		long fsize(void* archivefile, const String& filename);
-		void* freopen(void* file, void* archivefile, const String& filename);
-		Array<String> getFiles(void* archivefile);
-		FileInfo finfo(void* archivefile, const String& filename);
+		long fseek(void* file, long position);
+		long fsize(const String& filename);
+		FileInfo finfo(const String& filename);
+		bool exists(const String& filename, bool case_sensitive);
+		bool directoryExists(const String& dirname, bool case_sensitive);
+		Array<String> getDirectories(const String& dirname);
+		Array<String> getFiles(const String& dirname);
+		Array<String> getAllFiles();
+		long getCacheSize();
+		void setCacheSize(long value);
+		void clearCache();
+		void preload(const Array<String>& filenames);
 
 	}
 
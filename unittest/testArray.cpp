@@ -410,6 +410,45 @@ TEST(Array_difference)
 	CHECK((a1 / a2).size() == 0);
 }
 
+TEST(Array_set_operations_large)
+{
+	// large arrays use sorted lookups, but the order of elements has to stay the same
+	harray<hstr> a;
+	harray<hstr> b;
+	for (int i = 0; i < 300; i++)
+	{
+		a += hstr((i * 7) % 100);
+		b += hstr(i % 50 + 25);
+	}
+	harray<hstr> c = a.removed_duplicates();
+	CHECK(c.size() == 100);
+	CHECK(c[0] == "0" && c[1] == "7" && c[2] == "14");
+	harray<hstr> d = a.intersected(b);
+	CHECK(d.size() == 150);
+	CHECK(d[0] == "28" && d[1] == "35" && d[2] == "42");
+	harray<hstr> e = a.differentiated(b);
+	CHECK(e.size() == 150);
+	CHECK(e[0] == "0" && e[1] == "7" && e[2] == "14");
+	CHECK((d | e).size() == 100);
+	CHECK(a.remove_all(b) == 150);
+	CHECK(a == e);
+}
+
+TEST(Array_remove_all_aliased)
+{
+	// the removed element may be a reference into the same Array
+	harray<int> a;
+	a += 1;
+	a += 2;
+	a += 1;
+	a += 3;
+	CHECK(a.remove_all(a[0]) == 2);
+	CHECK(a.size() == 2 && a[0] == 2 && a[1] == 3);
+	a += 2;
+	a.differentiate(a[0]);
+	CHECK(a.size() == 1 && a[0] == 3);
+}
+
 TEST(Array_random)
 {
 	harray<int> a;
@@ -16,7 +16,10 @@
 #include <hltypes/exception.h>
 #include <hltypes/harray.h>
 #include <hltypes/hdir.h>
+#include <hltypes/hdirwatch.h>
 #include <hltypes/hfile.h>
+#include <hltypes/hparallel.h>
+#include <hltypes/hthreadpool.h>
 #include <hltypes/hstring.h>
 
 TEST(Dir_static_create_remove)
@@ -87,6 +90,180 @@ TEST(Dir_static_entries)
 	CHECK(data.contains("file2.txt"));
 }
 
+TEST(Dir_static_scan)
+{
+	hstr dirname = "testdir_scan";
+	hdir::create(dirname + "/dir1");
+	hfile::hwrite(dirname + "/file1.txt", "12345");
+	harray<hdirentry> entries = hdir::scan(dirname, true);
+	CHECK(entries.size() == 2);
+	foreach (hdirentry, it, entries)
+	{
+		if ((*it).name == "dir1")
+		{
+			CHECK((*it).type == hdirentry::DIRECTORY);
+		}
+		else
+		{
+			CHECK((*it).name == "file1.txt");
+			CHECK((*it).type == hdirentry::REGULAR_FILE);
+			CHECK((*it).size == 5);
+			CHECK((*it).modification_time > 0);
+		}
+	}
+	CHECK(hdir::scan(dirname + "/missing").size() == 0);
+	hdir::remove(dirname);
+}
+
+static bool _walk_filter(const hdirentry& entry)
+{
+	return !entry.name.ends_with(".skip");
+}
+
+static void _walk_nested(const hdirentry& entry, void* argument)
+{
+	if (entry.type == hdirentry::DIRECTORY)
+	{
+		hdirwalkoptions options;
+		options.parallel = true;
+		*((int*)argument) += hdir::walk("testdir_walk/" + entry.name, options).size();
+	}
+}
+
+TEST(Dir_static_walk)
+{
+	hstr dirname = "testdir_walk";
+	hdir::create(dirname + "/dir1/dir2");
+	hfile::create(dirname + "/file1.txt");
+	hfile::create(dirname + "/dir1/file2.txt");
+	hfile::create(dirname + "/dir1/dir2/file3.txt");
+	hfile::create(dirname + "/dir1/file4.skip");
+	harray<hdirentry> entries = hdir::walk(dirname);
+	harray<hstr> names;
+	foreach (hdirentry, it, entries)
+	{
+		names += (*it).name;
+	}
+	CHECK(names.size() == 6);
+	CHECK(names.contains("dir1/dir2"));
+	CHECK(names.contains("dir1/dir2/file3.txt"));
+	hdirwalkoptions options;
+	options.max_depth = 1;
+	CHECK(hdir::walk(dirname, options).size() == 5);
+	options.max_depth = -1;
+	options.filter = &_walk_filter;
+	CHECK(hdir::walk(dirname, options).size() == 5);
+	// an explicit pool, because the shared one doesn't exist on single core machines
+	hthreadpool pool(3);
+	hparallel::setThreadPool(&pool);
+	options.parallel = true;
+	CHECK(hdir::walk(dirname, options).size() == 5);
+	// callbacks may start parallel walks themselves, even when they are called from a worker
+	int count = 0;
+	hdir::walk(dirname, &_walk_nested, &count, options);
+	CHECK(count == 5);
+	hparallel::setThreadPool(NULL);
+	CHECK(hdir::walk(dirname + "/missing").size() == 0);
+	hdir::remove(dirname);
+}
+
+TEST(Dir_static_exists)
+{
+	hstr dirname = "testdir_exists";
+	hdir::create(dirname + "/Dir1");
+	hfile::create(dirname + "/File1.txt");
+	CHECK(hdir::exists(dirname + "/Dir1"));
+	CHECK(!hdir::exists(dirname + "/File1.txt"));
+	CHECK(!hfile::exists(dirname + "/Dir1"));
+	CHECK(!hdir::exists(dirname + "/dir1"));
+	CHECK(hdir::exists(dirname + "/dir1", false));
+	CHECK(hfile::exists(dirname + "/file1.TXT", false));
+	CHECK(!hfile::exists(dirname + "/dir1", false));
+	hdir::setCaseInsensitiveCache(true);
+	CHECK(hdir::exists(dirname + "/DIR1", false));
+	CHECK(hfile::exists(dirname + "/file1.txt", false));
+	CHECK(!hfile::exists(dirname + "/file2.txt", false));
+	hfile::create(dirname + "/File2.txt");
+	CHECK(hfile::exists(dirname + "/file2.txt", false));
+	hdir::setCaseInsensitiveCache(false);
+	hdir::remove(dirname);
+}
+
+static void _watch_changed(const hstr& dirname, void* argument)
+{
+	*((harray<hstr>*)argument) += dirname;
+}
+
+static void _watch_once(const hstr& dirname, void* argument)
+{
+	// callbacks can use cached listings and unsubscribe themselves
+	hdir::files(dirname);
+	hdirwatch::unsubscribe(&_watch_once, argument);
+	++(*((int*)argument));
+}
+
+TEST(Dir_watch)
+{
+	hstr dirname = "testdir_watch";
+	hdir::create(dirname + "/dir1");
+	hfile::create(dirname + "/file1.txt");
+	if (!hdirwatch::is_supported())
+	{
+		CHECK(!hdirwatch::add(dirname));
+		hdir::remove(dirname);
+		return;
+	}
+	harray<hstr> changed;
+	hdirwatch::subscribe(&_watch_changed, &changed);
+	CHECK(hdirwatch::add(dirname, true));
+	CHECK(hdirwatch::is_watched(dirname));
+	CHECK(hdirwatch::is_watched(dirname + "/dir1"));
+	CHECK(hdir::files(dirname).size() == 1);
+	CHECK(hdir::files(dirname).size() == 1);
+	hfile::create(dirname + "/file2.txt");
+	CHECK(hdir::files(dirname).size() == 2);
+	CHECK(changed.contains(dirname));
+	int calls = 0;
+	hdirwatch::subscribe(&_watch_once, &calls);
+	hfile::create(dirname + "/dir1/file6.txt");
+	CHECK(hdir::files(dirname + "/dir1").size() == 1);
+	hfile::remove(dirname + "/dir1/file6.txt");
+	CHECK(hdir::files(dirname + "/dir1").size() == 0);
+	CHECK(calls == 1);
+	CHECK(!hfile::exists(dirname + "/dir1/FILE3.txt", false));
+	hfile::create(dirname + "/dir1/file3.txt");
+	CHECK(hfile::exists(dirname + "/dir1/FILE3.txt", false));
+	hdir::create(dirname + "/dir2");
+	hdirwatch::update();
+	CHECK(hdirwatch::is_watched(dirname + "/dir2"));
+	hfile::hwrite(dirname + "/file1.txt", "12345");
+	harray<hdirentry> entries = hdir::scan(dirname, true);
+	CHECK(entries.size() == 4);
+	foreach (hdirentry, it, entries)
+	{
+		if ((*it).name == "file1.txt")
+		{
+			CHECK((*it).size == 5);
+		}
+	}
+	hdir::create(dirname + "/dir1/sub");
+	CHECK(hdir::files(dirname + "/dir1/sub").size() == 0);
+	hdir::rename(dirname + "/dir1", dirname + "/dir3");
+	hdir::create(dirname + "/dir1/sub");
+	CHECK(hdir::files(dirname + "/dir1/sub").size() == 0);
+	hfile::create(dirname + "/dir1/sub/file4.txt");
+	CHECK(hdir::files(dirname + "/dir1/sub").size() == 1);
+	CHECK(hdir::files(dirname + "/dir3/sub").size() == 0);
+	CHECK(hdirwatch::is_watched(dirname + "/dir3/sub"));
+	hfile::create(dirname + "/dir3/sub/file5.txt");
+	CHECK(hdir::files(dirname + "/dir3/sub").size() == 1);
+	hdirwatch::unsubscribe(&_watch_changed, &changed);
+	CHECK(hdirwatch::remove(dirname));
+	CHECK(!hdirwatch::is_watched(dirname + "/dir1"));
+	hdir::remove(dirname);
+	hdirwatch::clear();
+}
+
 TEST(Dir_static_clear)
 {
 	hstr dirname = "testdir";
@@ -153,3 +330,43 @@ TEST(Dir_static_copy)
 	hdir::remove(newdir + "/" + dirname);
 }
 
+static void _copy_parallel(void* argument)
+{
+	hstr* dirname = (hstr*)argument;
+	hdir::copy(*dirname, *dirname + "_copy", true);
+}
+
+TEST(Dir_static_copy_parallel)
+{
+	hstr dirname = "testdir_parallel";
+	hstr newdir = "testdir_parallel2";
+	hdir::remove(newdir);
+	for_iter (i, 0, 4)
+	{
+		hdir::create(dirname + hsprintf("/dir%d/dir", i));
+	}
+	for_iter (i, 0, 20)
+	{
+		hfile::hwrite(dirname + hsprintf("/dir%d/test.txt", i % 4), hsprintf("%d", i));
+		hfile::hwrite(dirname + hsprintf("/dir%d/dir/test%d.txt", i % 4, i), hsprintf("%d", i));
+	}
+	CHECK(hdir::copy(dirname, newdir, true));
+	CHECK(hdir::walk(newdir).size() == hdir::walk(dirname).size());
+	CHECK(hfile::hread(newdir + "/dir3/dir/test7.txt") == "7");
+	// a copy started on the only worker of the pool has to work on its own jobs while it waits
+	hthreadpool pool(1);
+	hparallel::setThreadPool(&pool);
+	htask* task = pool.submit(&_copy_parallel, &dirname);
+	task->wait();
+	delete task;
+	hparallel::setThreadPool(NULL);
+	CHECK(hdir::walk(dirname + "_copy").size() == hdir::walk(dirname).size());
+	hdir::remove(dirname + "_copy", true);
+	CHECK(hdir::clear(dirname, true));
+	CHECK(hdir::exists(dirname));
+	CHECK(hdir::walk(dirname).size() == 0);
+	CHECK(!hdir::clear(dirname, true));
+	hdir::remove(newdir, true);
+	CHECK(!hdir::exists(newdir));
+	hdir::remove(dirname);
+}
@@ -60,6 +60,120 @@ TEST(File_read_line)
 	CHECK(lines[0] == "This is a test." && lines[1] == "This is also a test." && lines[2] == "This is another test.");
 }
 
+TEST(File_line_cursor)
+{
+	hstr filename = "test.txt";
+	hfile f(filename, hfile::WRITE);
+	f.write_line(hstr('a', 5000));
+	f.write_line("This is a test.");
+	f.write("This is another test.");
+	f.open(filename, hfile::READ);
+	hlcursor* cursor = new hlcursor(&f);
+	CHECK(cursor->next());
+	CHECK(cursor->getString() == hstr('a', 5000));
+	CHECK(cursor->next());
+	CHECK(cursor->getString() == "This is a test.");
+	delete cursor;
+	CHECK(f.position() == 5017);
+	cursor = new hlcursor(&f);
+	CHECK(cursor->next());
+	CHECK(cursor->getString() == "This is another test.");
+	CHECK(!cursor->next());
+	delete cursor;
+	CHECK(f.eof());
+}
+
+TEST(File_read_mapped)
+{
+	hstr filename = "test.txt";
+	hfile f(filename, hfile::WRITE);
+	f.write_line("This is a test.");
+	f.write("This is another test.");
+	f.dump(1234);
+	f.open(filename, hfile::READ_MAPPED);
+	CHECK(f.size() == 41);
+	CHECK(f.read_line() == "This is a test.");
+	CHECK(f.read(21) == "This is another test.");
+	CHECK(f.load_int() == 1234);
+	CHECK(f.eof());
+	f.seek(-25, hfile::CURRENT);
+	CHECK(f.read(4) == "This");
+	f.seek(100, hfile::START);
+	CHECK(f.position() == 41);
+#ifndef _WIN32
+	CHECK(f.getMappedData() != NULL);
+#endif
+	f.rewind();
+	hlcursor* cursor = new hlcursor(&f);
+	CHECK(cursor->next());
+	CHECK(cursor->getString() == "This is a test.");
+	delete cursor;
+	CHECK(f.position() == 16);
+	f.close();
+	f.open(filename, hfile::WRITE);
+	f.close();
+	f.open(filename, hfile::READ_MAPPED);
+	CHECK(f.size() == 0);
+	CHECK(f.read() == "");
+	CHECK(f.eof());
+}
+
+TEST(File_write_batch)
+{
+	hstr filename = "test.txt";
+	hfile f(filename, hfile::WRITE);
+	double values[100];
+	for_iter (i, 0, 100)
+	{
+		values[i] = i * 0.5;
+	}
+	{
+		hwbatch batch(&f);
+		for_iter (i, 0, 100)
+		{
+			f.dump(i);
+		}
+		f.dump_array(values, 100);
+		CHECK(f.size() == 1200);
+	}
+	CHECK(f.size() == 1200);
+	f.open(filename, hfile::READ);
+	for_iter (i, 0, 100)
+	{
+		CHECK(f.load_int() == i);
+	}
+	double loaded[100];
+	CHECK(f.load_array(loaded, 100) == 100);
+	CHECK(loaded[99] == 49.5);
+	CHECK(f.eof());
+}
+
+TEST(File_size_tracking)
+{
+	hstr filename = "test.txt";
+	hfile f(filename, hfile::WRITE);
+	f.write_line("This is a test.");
+	CHECK(f.size() == 16);
+	f.seek(5, hfile::START);
+	f.write("XX");
+	CHECK(f.size() == 16);
+	f.seek(0, hfile::END);
+	f.write("This is another test.");
+	CHECK(f.size() == 37);
+	f.open(filename, hfile::READ);
+	CHECK(f.size() == 37);
+	hfile::happend(filename, "123");
+	CHECK(f.size() == 37);
+	f.refresh_size();
+	CHECK(f.size() == 40);
+	f.open(filename, hfile::APPEND);
+	CHECK(f.size() == 40);
+	f.write("4567");
+	CHECK(f.size() == 44);
+	f.close();
+	CHECK(hfile::hread(filename) == "This XX a test.\nThis is another test.1234567");
+}
+
 TEST(File_read_delimiter)
 {
 	hstr filename = "test.txt";
@@ -162,6 +276,27 @@ TEST(File_serialization)
 	CHECK(!b);
 }
 
+TEST(File_static_copy_large)
+{
+	hstr old_filename = "test.txt";
+	hstr new_filename = "test2.txt";
+	hfile::remove(new_filename);
+	hstr text;
+	for_iter (i, 0, 20000)
+	{
+		text += hsprintf("%d,", i);
+	}
+	hfile::hwrite(old_filename, text);
+	CHECK(hfile::copy(old_filename, new_filename));
+	CHECK(!hfile::copy(old_filename, new_filename));
+	CHECK(hfile::hread(new_filename) == text);
+	hfile::hwrite(old_filename, "");
+	CHECK(hfile::copy(old_filename, new_filename, true));
+	CHECK(hfile::hsize(new_filename) == 0);
+	hfile::remove(old_filename);
+	hfile::remove(new_filename);
+}
+
 TEST(File_static_create_remove)
 {
 	hstr filename = "test2.txt";
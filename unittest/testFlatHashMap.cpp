@@ -0,0 +1,147 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+
+#ifdef _WIN32
+#include <UnitTest++.h>
+#else
+#include <unittest++/UnitTest++.h>
+#endif
+
+#include <hltypes/hflathashmap.h>
+#include <hltypes/hmap.h>
+#include <hltypes/hstring.h>
+
+TEST(FlatHashMap_adding)
+{
+	hflathashmap<hstr, int> a;
+	a["a"] = 1;
+	a["abc"] = 2;
+	a["test"] = 7;
+	CHECK(a.size() == 3);
+	CHECK(a["a"] == 1);
+	CHECK(a["abc"] == 2);
+	CHECK(a.value_of("test") == 7);
+	CHECK(a(2) == "abc");
+	CHECK(a.key_of(7) == "test");
+	CHECK(a.has_value(1));
+	CHECK(!a.has_value(6));
+	CHECK(a.has_key("abc"));
+	CHECK(!a.has_key("key"));
+	harray<hstr> keys = a.keys();
+	CHECK(keys.size() == 3);
+	CHECK(keys.contains("a"));
+	CHECK(keys.contains("test"));
+	CHECK(a.has_keys(keys));
+	keys += "not existent";
+	CHECK(!a.has_keys(keys));
+	harray<int> values = a.values();
+	CHECK(values.size() == 3);
+	CHECK(a.has_values(values));
+}
+
+TEST(FlatHashMap_removing)
+{
+	hflathashmap<hstr, int> a;
+	a["A"] = 1;
+	a["B"] = 2;
+	a["C"] = 7;
+	a.remove_key("A");
+	CHECK(!a.has_key("A"));
+	a.remove_key("A");
+	CHECK(a.size() == 2);
+	a.remove_value(7);
+	CHECK(!a.has_value(7));
+	harray<hstr> keys;
+	keys += "B";
+	a.remove_keys(keys);
+	CHECK(a.size() == 0);
+	CHECK(a.begin() == a.end());
+}
+
+TEST(FlatHashMap_structure)
+{
+	hflathashmap<hstr, int> a;
+	a["A"] = 1;
+	a["B"] = 2;
+	hflathashmap<hstr, int> b = a;
+	CHECK(a == b);
+	CHECK(!(a != b));
+	b.clear();
+	b["A"] = 5;
+	b["D"] = 6;
+	CHECK(a != b);
+	CHECK(a.try_get_by_key("E", 10) == 10);
+	a.insert(b); // does not overwrite already existing keys
+	CHECK(a["A"] == 1);
+	CHECK(a["D"] == 6);
+	a.inject(b); // overwrites already existing keys
+	CHECK(a["A"] == 5);
+	CHECK(a.try_get_by_key("D", 10) == 6);
+	int count = 0;
+	foreach_fm (int, it, a)
+	{
+		CHECK(a[it->first] == it->second);
+		count++;
+	}
+	CHECK(count == a.size());
+}
+
+bool odd_flat_values(int key, int value) { return (value % 2 == 1); }
+
+TEST(FlatHashMap_match)
+{
+	hflathashmap<int, int> a;
+	for (int i = 0; i < 1000; i++)
+	{
+		a[i] = i * 3;
+	}
+	CHECK(a.size() == 1000);
+	CHECK(a.matches_any(&odd_flat_values));
+	CHECK(!a.matches_all(&odd_flat_values));
+	hflathashmap<int, int> b = a.find_all(&odd_flat_values);
+	CHECK(b.size() == 500);
+	CHECK(b.matches_all(&odd_flat_values));
+	int value = 0;
+	int key = a.random(&value);
+	CHECK(a[key] == value);
+	CHECK(a.random(10).size() == 10);
+}
+
+TEST(FlatHashMap_pointers)
+{
+	// many insertions and removals leave deleted slots that have to be reused or cleared up
+	int data[2000];
+	hflathashmap<int*, int> a;
+	hmap<int*, int> b;
+	int* key = NULL;
+	for (int i = 0; i < 20000; i++)
+	{
+		key = &data[hrand(2000)];
+		if (hrand(3) == 0)
+		{
+			a.remove_key(key);
+			b.remove_key(key);
+		}
+		else
+		{
+			a[key] = i;
+			b[key] = i;
+		}
+	}
+	CHECK(a.size() == b.size());
+	bool equal = true;
+	foreach_map (int*, int, it, b)
+	{
+		equal = equal && (a.try_get_by_key(it->first, -1) == it->second);
+	}
+	CHECK(equal);
+	a.clear();
+	CHECK(a.size() == 0);
+	CHECK(!a.has_key(&data[0]));
+}
@@ -0,0 +1,108 @@
+/// @file
+/// @author  Boris Mikic
+/// @version 2.3
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://www.opensource.org/licenses/bsd-license.php
+
+#ifdef _WIN32
+#include <UnitTest++.h>
+#else
+#include <unittest++/UnitTest++.h>
+#endif
+
+#include <hltypes/harray.h>
+#include <hltypes/hlog.h>
+#include <hltypes/hstring.h>
+
+class CollidingLog : public hlog
+{
+public:
+	// stores a filter under the hash of another tag like it would happen if both tags had the same hash
+	static void addFilter(const hstr& tag, const hstr& other)
+	{
+		unsigned long long hash = other.hash();
+		int index = 0;
+		while (index < tag_filter_hashes.size() && tag_filter_hashes[index] < hash)
+		{
+			++index;
+		}
+		tag_filter_hashes.insert_at(index, hash);
+		tag_filters.insert_at(index, tag);
+	}
+
+};
+
+int evaluations = 0;
+
+int evaluate(int value)
+{
+	++evaluations;
+	return value;
+}
+
+TEST(Log_levels)
+{
+	bool debug = hlog::isLevelDebug();
+	hlog::setLevels(true, false, true, false);
+	CHECK(hlog::isAllowed("", hlog::LevelWrite));
+	CHECK(!hlog::isAllowed("", hlog::LevelError));
+	CHECK(hlog::isAllowed("test", hlog::LevelWarn));
+	CHECK(!hlog::isAllowed("test", hlog::LevelDebug));
+	CHECK(!hlog::errorf("test", "%d", 1));
+	hlog::setLevels(true, true, true, debug);
+}
+
+TEST(Log_tag_filters)
+{
+	harray<hstr> filters;
+	filters += "alpha";
+	filters += "beta";
+	filters += "beta";
+	hlog::setTagFilters(filters);
+	CHECK(hlog::isAllowed("alpha", hlog::LevelWrite));
+	CHECK(hlog::isAllowed("beta", hlog::LevelWrite));
+	CHECK(!hlog::isAllowed("gamma", hlog::LevelWrite));
+	CHECK(!hlog::isAllowed("alph", hlog::LevelWrite));
+	// messages without a tag are never filtered
+	CHECK(hlog::isAllowed("", hlog::LevelWrite));
+	CHECK(!hlog::writef("gamma", "%d", 1));
+	// tags with the same hash are told apart by comparing the tags themselves
+	CollidingLog::addFilter("delta", "alpha");
+	CHECK(hlog::isAllowed("alpha", hlog::LevelWrite));
+	CHECK(!hlog::isAllowed("delta", hlog::LevelWrite));
+	filters.clear();
+	filters += "beta";
+	hlog::setTagFilters(filters);
+	CollidingLog::addFilter("delta", "alpha");
+	CHECK(!hlog::isAllowed("alpha", hlog::LevelWrite));
+	CHECK(hlog::isAllowed("beta", hlog::LevelWrite));
+	hlog::setTagFilters(harray<hstr>());
+	CHECK(hlog::isAllowed("gamma", hlog::LevelWrite));
+}
+
+TEST(Log_macros)
+{
+	bool debug = hlog::isLevelDebug();
+	evaluations = 0;
+	hlog::setLevelDebug(false);
+	hlog_debugf("test", "%d", evaluate(1));
+	CHECK(evaluations == 0);
+	hlog::setLevelDebug(true);
+	hlog_debugf("test", "%d", evaluate(1));
+	CHECK(evaluations == 1);
+	hlog::setLevelWarn(false);
+	hlog_warnf("test", "%d", evaluate(1));
+	CHECK(evaluations == 1);
+	hlog::setLevelWarn(true);
+	// only the level is checked before the arguments are evaluated, the tag is filtered before formatting
+	harray<hstr> filters;
+	filters += "other";
+	hlog::setTagFilters(filters);
+	hlog_writef("test", "%d", evaluate(1));
+	CHECK(evaluations == 2);
+	hlog::setTagFilters(harray<hstr>());
+	hlog::setLevelDebug(debug);
+}
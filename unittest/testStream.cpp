@@ -53,6 +53,26 @@ TEST(Stream_read_line)
 	CHECK(lines[0] == "This is a test." && lines[1] == "This is also a test." && lines[2] == "This is another test.");
 }
 
+TEST(Stream_line_cursor)
+{
+	hstream s;
+	s.write("This is a test.\r\n\nThis is another test.");
+	s.rewind();
+	hlcursor* cursor = new hlcursor(&s);
+	CHECK(cursor->next());
+	CHECK(cursor->getString() == "This is a test.");
+	CHECK(cursor->next());
+	CHECK(cursor->getSize() == 0);
+	delete cursor;
+	CHECK(s.position() == 18);
+	cursor = new hlcursor(&s);
+	CHECK(cursor->next());
+	CHECK(cursor->getString() == "This is another test.");
+	CHECK(!cursor->next());
+	delete cursor;
+	CHECK(s.eof());
+}
+
 TEST(Stream_read_delimiter)
 {
 	hstream s;
@@ -61,6 +81,16 @@ TEST(Stream_read_delimiter)
 	s.rewind();
 	hstr text = s.read(hstr('b', 10));
 	CHECK(text == hstr('a', 4090));
+	s.clear();
+	s.write(hstr('a', 4095));
+	s.write("\r\nbc\r\n");
+	s.rewind();
+	text = s.read("\r\n");
+	CHECK(text == hstr('a', 4095));
+	CHECK(s.position() == 4097);
+	text = s.read_line();
+	CHECK(text == "bc");
+	CHECK(s.eof());
 }
 
 TEST(Stream_writef)
@@ -146,3 +176,26 @@ TEST(Stream_serialization)
 	CHECK(!b);
 }
 
+
+TEST(Stream_serialization_array)
+{
+	hstream s;
+	float floats[5] = {0.0f, 1.5f, -2.25f, 3.0f, 1000.125f};
+	harray<int> ints;
+	ints += 1;
+	ints += -2;
+	ints += 300000;
+	s.dump_array(floats, 5);
+	s.dump_array(ints);
+	s.dump_array(harray<short>());
+	CHECK(s.size() == 40);
+	s.rewind();
+	float loaded[5] = {0.0f};
+	CHECK(s.load_array(loaded, 5) == 5);
+	CHECK(loaded[2] == -2.25f);
+	CHECK(loaded[4] == 1000.125f);
+	CHECK(s.load_array<int>() == ints);
+	CHECK(s.load_array<short>().size() == 0);
+	CHECK(s.eof());
+	CHECK(s.load_array(loaded, 5) == 0);
+}
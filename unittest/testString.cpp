@@ -312,3 +312,24 @@ TEST(String_hsprintf)
 	CHECK(text == "This is a 15 formatted 3.14 text.");
 }
 
+
+TEST(String_hash)
+{
+	hstr a = "This is a test string that is longer than 48 characters for hashing.";
+	hstr b = a;
+	CHECK(a.hash() == b.hash());
+	CHECK(a.hash() != a.hash(1));
+	b[10] = 'X';
+	CHECK(a.hash() != b.hash());
+	CHECK(hstr("").hash() == hstr("").hash());
+	CHECK(hstr("abc").hash() != hstr("abd").hash());
+	CHECK(hstr("abcdefgh").hash() != hstr("abcdefgi").hash());
+	// test vectors of the wyhash reference implementation, covering all code paths
+	CHECK(hstr("").hash(0) == 0x93228A4DE0EEC5A2ULL);
+	CHECK(hstr("a").hash(1) == 0xC5BAC3DB178713C4ULL);
+	CHECK(hstr("abc").hash(2) == 0xA97F2F7B1D9B3314ULL);
+	CHECK(hstr("message digest").hash(3) == 0x786D1F1DF3801DF4ULL);
+	CHECK(hstr("abcdefghijklmnopqrstuvwxyz").hash(4) == 0xDCA5A8138AD37C87ULL);
+	CHECK(hstr("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789").hash(5) == 0xB9E734F117CFAF70ULL);
+	CHECK(hstr("12345678901234567890123456789012345678901234567890123456789012345678901234567890").hash(6) == 0x6CC5EAB49A92D617ULL);
+}
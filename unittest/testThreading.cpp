@@ -15,11 +15,22 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#include <hltypes/exception.h>
+#include <hltypes/hcondition.h>
+#include <hltypes/hcrc32.h>
+#include <hltypes/hfile.h>
+#include <hltypes/hlog.h>
 #include <hltypes/hmutex.h>
+#include <hltypes/hparallel.h>
+#include <hltypes/hresource.h>
+#include <hltypes/hrwmutex.h>
+#include <hltypes/hsemaphore.h>
 #include <hltypes/hstring.h>
 #include <hltypes/hthread.h>
+#include <hltypes/hthreadpool.h>
 
 hstr output;
 hmutex mutex;
@@ -106,3 +117,620 @@ TEST(Threading_control)
 	CHECK(output.count('2') == 10);
 }
 
+void increment(void* argument)
+{
+	mutex.lock();
+	++(*(int*)argument);
+	mutex.unlock();
+}
+
+TEST(Threading_pool)
+{
+	int counter = 0;
+	hthreadpool pool(4);
+	CHECK(pool.getWorkerCount() == 4);
+	harray<htask*> tasks;
+	for (int i = 0; i < 100; i++)
+	{
+		tasks += pool.submit(&increment, &counter);
+	}
+	tasks[99]->wait();
+	CHECK(tasks[99]->isDone());
+	pool.wait();
+	CHECK(counter == 100);
+	foreach (htask*, it, tasks)
+	{
+		CHECK((*it)->isDone());
+		delete (*it);
+	}
+	CHECK(hthreadpool::getCpuCount() >= 1);
+}
+
+hthreadpool* nested_pool = NULL;
+
+void submit_nested(void* argument)
+{
+	harray<htask*> tasks;
+	for (int i = 0; i < 4; i++)
+	{
+		tasks += nested_pool->submit(&increment, argument);
+	}
+	// the worker executes queued tasks while waiting so all workers can wait at the same time
+	foreach (htask*, it, tasks)
+	{
+		(*it)->wait();
+		delete (*it);
+	}
+}
+
+TEST(Threading_pool_nested)
+{
+	int counter = 0;
+	hthreadpool pool(2);
+	nested_pool = &pool;
+	harray<htask*> tasks;
+	for (int i = 0; i < 8; i++)
+	{
+		tasks += pool.submit(&submit_nested, &counter);
+	}
+	foreach (htask*, it, tasks)
+	{
+		(*it)->wait();
+		delete (*it);
+	}
+	pool.wait();
+	CHECK(counter == 32);
+	nested_pool = NULL;
+}
+
+hsemaphore semaphore;
+hcondition condition;
+bool ready = false;
+
+void produce(hthread*)
+{
+	for (int i = 0; i < 10; i++)
+	{
+		semaphore.release();
+	}
+	hscopelock lock(&condition);
+	ready = true;
+	condition.broadcast();
+}
+
+TEST(Threading_condition_semaphore)
+{
+	ready = false;
+	hthread t(&produce);
+	t.start();
+	condition.lock();
+	while (!ready)
+	{
+		condition.wait();
+	}
+	condition.unlock();
+	for (int i = 0; i < 10; i++)
+	{
+		CHECK(semaphore.acquire(1000.0f));
+	}
+	CHECK(!semaphore.try_acquire());
+	CHECK(!semaphore.acquire(10.0f));
+	t.join();
+	// waiting can end without a signal so only the waited for state and the elapsed time are checked
+	ready = false;
+	unsigned int start = get_system_tick_count();
+	condition.lock();
+	while (!ready && get_system_tick_count() - start < 10)
+	{
+		condition.wait(10.0f);
+	}
+	CHECK(!ready);
+	condition.unlock();
+	CHECK(get_system_tick_count() - start >= 10);
+}
+
+TEST(Threading_read_write_mutex)
+{
+	hrwmutex rw_mutex;
+	rw_mutex.lock_read();
+	rw_mutex.lock_read();
+	rw_mutex.unlock_read();
+	rw_mutex.unlock_read();
+	{
+		hscopelock lock(&rw_mutex, true);
+	}
+	hscopelock lock(&rw_mutex);
+	lock.release();
+	rw_mutex.lock_write();
+	rw_mutex.unlock_write();
+}
+
+hmutex statistics_mutex("statistics_mutex");
+
+void contend(hthread*)
+{
+	for (int i = 0; i < 1000; i++)
+	{
+		statistics_mutex.lock();
+		statistics_mutex.unlock();
+	}
+}
+
+TEST(Threading_mutex_statistics)
+{
+	hmutex::setStatisticsEnabled(true);
+	statistics_mutex.setAdaptive(true);
+	statistics_mutex.resetStatistics();
+	hthread t1(&contend);
+	hthread t2(&contend);
+	t1.start();
+	t2.start();
+	t1.join();
+	t2.join();
+	hltypes::MutexStatistics statistics = statistics_mutex.getStatistics();
+	CHECK(statistics.name == "statistics_mutex");
+	CHECK(statistics.acquisitions == 2000);
+	CHECK(statistics.contentions <= statistics.acquisitions);
+	CHECK(statistics.wait_time >= 0.0);
+	bool found = false;
+	// must not lock the Mutexes themselves
+	statistics_mutex.lock();
+	harray<hltypes::MutexStatistics> all = hmutex::getAllStatistics();
+	statistics_mutex.unlock();
+	foreach (hltypes::MutexStatistics, it, all)
+	{
+		if ((*it).name == "statistics_mutex")
+		{
+			found = true;
+		}
+	}
+	CHECK(found);
+	hmutex::setStatisticsEnabled(false);
+}
+
+#define LOG_PRODUCERS 4
+#define LOG_MESSAGES 25
+#define LOG_QUEUE_SIZE 4
+
+hmutex log_producer_mutex;
+int log_producer_index = 0;
+hcondition log_callback_condition;
+int log_callback_count = 0;
+bool log_callback_blocking = false;
+bool log_callback_blocked = false;
+
+void produce_log(hthread*)
+{
+	log_producer_mutex.lock();
+	int index = log_producer_index;
+	++log_producer_index;
+	log_producer_mutex.unlock();
+	for (int i = 0; i < LOG_MESSAGES; i++)
+	{
+		hlog::writef("async", "%d %d", index, i);
+	}
+}
+
+void count_log(const hstr& /*tag*/, const hstr& /*message*/)
+{
+	hscopelock lock(&log_callback_condition);
+	++log_callback_count;
+	// keeps the writer thread busy so the queue fills up
+	log_callback_blocked = log_callback_blocking;
+	log_callback_condition.broadcast();
+	while (log_callback_blocking)
+	{
+		log_callback_condition.wait();
+	}
+}
+
+TEST(Threading_async_log)
+{
+	hstr filename = "test_async.log";
+	int queueSize = hlog::getQueueSize();
+	hlog::setFilename(filename);
+	hlog::setCallbackFunction(&count_log);
+	// small queue so producers have to wait for the writer thread
+	hlog::setQueueSize(LOG_QUEUE_SIZE);
+	hlog::setAsync(true);
+	log_producer_index = 0;
+	log_callback_count = 0;
+	hthread* threads[LOG_PRODUCERS];
+	for (int i = 0; i < LOG_PRODUCERS; i++)
+	{
+		threads[i] = new hthread(&produce_log);
+		threads[i]->start();
+	}
+	for (int i = 0; i < LOG_PRODUCERS; i++)
+	{
+		threads[i]->join();
+		delete threads[i];
+	}
+	hlog::flush();
+	CHECK(log_callback_count == LOG_PRODUCERS * LOG_MESSAGES);
+	hlog::finalize(false);
+	harray<hstr> lines = hfile::hread(filename).split('\n', -1, true);
+	CHECK(lines.size() == LOG_PRODUCERS * LOG_MESSAGES);
+	int next[LOG_PRODUCERS] = {0};
+	bool ordered = true;
+	harray<hstr> parts;
+	foreach (hstr, it, lines)
+	{
+		parts = (*it).split(' ');
+		ordered = ordered && (parts.size() == 3 && parts[0] == "[async]" && (int)parts[2] == next[(int)parts[1]]);
+		if (ordered)
+		{
+			++next[(int)parts[1]];
+		}
+	}
+	CHECK(ordered);
+	// messages that don't fit into the queue while the writer thread is busy are dropped
+	hlog::setFilename(filename);
+	hlog::setDropWhenFull(true);
+	int dropped = hlog::getDroppedCount();
+	log_callback_count = 0;
+	log_callback_blocking = true;
+	log_callback_blocked = false;
+	CHECK(hlog::write("async", "blocking"));
+	log_callback_condition.lock();
+	while (!log_callback_blocked)
+	{
+		log_callback_condition.wait();
+	}
+	log_callback_condition.unlock();
+	for (int i = 0; i < LOG_QUEUE_SIZE; i++)
+	{
+		CHECK(hlog::writef("async", "queued %d", i));
+	}
+	CHECK(!hlog::write("async", "dropped"));
+	CHECK(!hlog::write("async", "dropped"));
+	CHECK(hlog::getDroppedCount() - dropped == 2);
+	log_callback_condition.lock();
+	log_callback_blocking = false;
+	log_callback_condition.broadcast();
+	log_callback_condition.unlock();
+	// turning it off processes everything that is still queued
+	hlog::setAsync(false);
+	CHECK(log_callback_count == LOG_QUEUE_SIZE + 1);
+	hlog::finalize(false);
+	lines = hfile::hread(filename).split('\n', -1, true);
+	CHECK(lines.size() == LOG_QUEUE_SIZE + 1);
+	CHECK(lines.size() > 0 && lines.last() == hsprintf("[async] queued %d", LOG_QUEUE_SIZE - 1));
+	hlog::setDropWhenFull(false);
+	hlog::setQueueSize(queueSize);
+	hlog::setCallbackFunction(NULL);
+	hlog::setFilename("", false);
+	hfile::remove(filename);
+}
+
+#ifdef _ZIPRESOURCE
+// large enough that discarding whole seek distances at once would be noticed
+#define RESOURCE_SIZE 4194304
+#define RESOURCE_BLOCK_SIZE 65535
+// input, window and checkpoints of all open files together stay far below this
+#define RESOURCE_MEMORY_LIMIT 8388608
+#else
+#define RESOURCE_SIZE 100000
+#endif
+
+int resource_errors = 0;
+
+void seek_resource(hthread* thread)
+{
+	unsigned int seed = (unsigned int)(size_t)thread;
+	char buffer[16];
+	long position = 0;
+	bool correct = true;
+	try
+	{
+		hresource resource("test_resource.txt");
+		for (int i = 0; i < 200; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			position = (long)((seed >> 8) % (RESOURCE_SIZE - 16));
+			switch (i % 3)
+			{
+			case 0:
+				resource.seek(position, hresource::START);
+				break;
+			case 1:
+				resource.seek(position - resource.position(), hresource::CURRENT);
+				break;
+			case 2:
+				resource.seek(position - RESOURCE_SIZE, hresource::END);
+				break;
+			}
+			correct = (resource.read_raw(buffer, 16) == 16 && resource.position() == position + 16);
+			for (int j = 0; j < 16 && correct; j++)
+			{
+				correct = (buffer[j] == '0' + (position + j) % 10);
+			}
+			if (!correct)
+			{
+				mutex.lock();
+				resource_errors++;
+				mutex.unlock();
+			}
+		}
+	}
+	catch (hltypes::exception&)
+	{
+		// an exception must not leave the thread
+		mutex.lock();
+		resource_errors++;
+		mutex.unlock();
+	}
+}
+
+#ifdef _ZIPRESOURCE
+void write_zip_value(harray<unsigned char>& data, unsigned int value, int size)
+{
+	for (int i = 0; i < size; i++)
+	{
+		data += (unsigned char)((value >> (i * 8)) & 0xFF);
+	}
+}
+
+// deflate packs values starting with their least significant bit
+void write_deflate_bits(harray<unsigned char>& data, unsigned int& buffer, int& count, unsigned int value, int size)
+{
+	buffer |= value << count;
+	count += size;
+	while (count >= 8)
+	{
+		data += (unsigned char)(buffer & 0xFF);
+		buffer >>= 8;
+		count -= 8;
+	}
+}
+
+// Huffman codes are packed starting with their most significant bit
+unsigned int reverse_deflate_code(unsigned int code, int size)
+{
+	unsigned int result = 0;
+	for (int i = 0; i < size; i++)
+	{
+		result = (result << 1) | ((code >> i) & 1);
+	}
+	return result;
+}
+
+// the entry uses deflate with stored blocks or with fixed Huffman codes for literals only so no compressor is needed, unlike stored
+// blocks the fixed Huffman blocks end in the middle of a byte
+void write_zip_archive(const hstr& filename, const hstr& name, const hstr& text, bool huffman)
+{
+	harray<unsigned char> deflated;
+	int size = 0;
+	unsigned int buffer = 0;
+	int count = 0;
+	for (int i = 0; i < text.size(); i += RESOURCE_BLOCK_SIZE)
+	{
+		size = hmin(RESOURCE_BLOCK_SIZE, text.size() - i);
+		if (huffman)
+		{
+			write_deflate_bits(deflated, buffer, count, (i + size >= text.size() ? 1 : 0) | (1 << 1), 3);
+			for (int j = 0; j < size; j++)
+			{
+				// literals 0 to 143 use the 8 bit codes 0x30 to 0xBF
+				write_deflate_bits(deflated, buffer, count, reverse_deflate_code(0x30 + (unsigned char)text[i + j], 8), 8);
+			}
+			write_deflate_bits(deflated, buffer, count, 0, 7); // end of block
+		}
+		else
+		{
+			deflated += (unsigned char)(i + size >= text.size() ? 1 : 0);
+			write_zip_value(deflated, size, 2);
+			write_zip_value(deflated, ~size & 0xFFFF, 2);
+			deflated.add((unsigned char*)&text.c_str()[i], size);
+		}
+	}
+	if (count > 0)
+	{
+		deflated += (unsigned char)(buffer & 0xFF);
+	}
+	hcrc32 crc;
+	crc.update((const unsigned char*)text.c_str(), text.size());
+	unsigned int checksum = crc.final();
+	harray<unsigned char> header;
+	write_zip_value(header, 20, 2); // version needed
+	write_zip_value(header, 0, 2); // flags
+	write_zip_value(header, 8, 2); // deflate
+	write_zip_value(header, 0, 2); // time
+	write_zip_value(header, 0x21, 2); // date
+	write_zip_value(header, checksum, 4);
+	write_zip_value(header, deflated.size(), 4);
+	write_zip_value(header, text.size(), 4);
+	write_zip_value(header, name.size(), 2);
+	write_zip_value(header, 0, 2); // extra field
+	harray<unsigned char> data;
+	write_zip_value(data, 0x04034B50, 4);
+	data += header;
+	data.add((unsigned char*)name.c_str(), name.size());
+	data += deflated;
+	int directoryOffset = data.size();
+	write_zip_value(data, 0x02014B50, 4);
+	write_zip_value(data, 20, 2); // version made by
+	data += header;
+	write_zip_value(data, 0, 2); // comment
+	write_zip_value(data, 0, 2); // disk
+	write_zip_value(data, 0, 2); // internal attributes
+	write_zip_value(data, 0, 4); // external attributes
+	write_zip_value(data, 0, 4); // local header offset
+	data.add((unsigned char*)name.c_str(), name.size());
+	int directorySize = data.size() - directoryOffset;
+	write_zip_value(data, 0x06054B50, 4);
+	write_zip_value(data, 0, 2); // disk
+	write_zip_value(data, 0, 2); // directory disk
+	write_zip_value(data, 1, 2); // entries on disk
+	write_zip_value(data, 1, 2); // entries
+	write_zip_value(data, directorySize, 4);
+	write_zip_value(data, directoryOffset, 4);
+	write_zip_value(data, 0, 2); // comment
+	hfile file(filename, hfile::WRITE);
+	file.write_raw(&data[0], data.size());
+}
+#endif
+
+#ifdef __linux__
+// returns -1 if the value is not available
+long read_memory_status(const char* key)
+{
+	long result = -1;
+	FILE* f = fopen("/proc/self/status", "r");
+	if (f != NULL)
+	{
+		char line[256];
+		while (fgets(line, 256, f) != NULL)
+		{
+			if (strncmp(line, key, strlen(key)) == 0)
+			{
+				result = atol(line + strlen(key) + 1) * 1024;
+				break;
+			}
+		}
+		fclose(f);
+	}
+	return result;
+}
+
+// returns false if the peak memory usage can't be reset on this system
+bool reset_memory_peak()
+{
+	FILE* f = fopen("/proc/self/clear_refs", "w");
+	if (f == NULL)
+	{
+		return false;
+	}
+	bool result = (fputs("5", f) >= 0);
+	return (fclose(f) == 0 && result);
+}
+#endif
+
+// returns false if the memory usage was too high
+bool seek_resources()
+{
+	resource_errors = 0;
+	harray<hthread*> threads;
+	for (int i = 0; i < 8; i++)
+	{
+		threads += new hthread(&seek_resource);
+	}
+#if defined(_ZIPRESOURCE) && defined(__linux__)
+	long memory = read_memory_status("VmRSS:");
+	bool measured = (memory >= 0 && reset_memory_peak());
+#endif
+	foreach (hthread*, it, threads)
+	{
+		(*it)->start();
+	}
+	foreach (hthread*, it, threads)
+	{
+		(*it)->join();
+		delete (*it);
+	}
+#if defined(_ZIPRESOURCE) && defined(__linux__)
+	if (measured)
+	{
+		return (read_memory_status("VmHWM:") - memory < RESOURCE_MEMORY_LIMIT);
+	}
+#endif
+	return true;
+}
+
+TEST(Threading_resource_seek)
+{
+	hstr data;
+	for (int i = 0; i < RESOURCE_SIZE; i++)
+	{
+		data += (char)('0' + i % 10);
+	}
+#ifdef _ZIPRESOURCE
+	// seeking in compressed archive entries is what needs the discard buffers
+	hstr archive = hresource::getArchive();
+	write_zip_archive("test_resource.zip", "test_resource.txt", data, false);
+	hresource::setArchive("test_resource.zip");
+	CHECK(hresource::exists("test_resource.txt"));
+#else
+	hfile::hwrite("test_resource.txt", data);
+#endif
+	CHECK(seek_resources());
+	CHECK(resource_errors == 0);
+#ifdef _ZIPRESOURCE
+	// checkpoints at the end of fixed Huffman blocks have to restore the bits of a partially used byte
+	write_zip_archive("test_resource_huffman.zip", "test_resource.txt", data, true);
+	hresource::setArchive("test_resource_huffman.zip");
+	CHECK(hresource::exists("test_resource.txt"));
+	CHECK(seek_resources());
+	CHECK(resource_errors == 0);
+	hresource::setArchive(archive);
+	hfile::remove("test_resource.zip");
+	hfile::remove("test_resource_huffman.zip");
+#else
+	hfile::remove("test_resource.txt");
+#endif
+}
+
+struct SortEntry
+{
+	int key;
+	int index;
+	SortEntry(int key = 0, int index = 0) : key(key), index(index) { }
+};
+
+bool sort_entry_less(SortEntry a, SortEntry b) { return (a.key < b.key); }
+bool odd_number(int value) { return (value % 2 == 1); }
+int square_number(int value) { return (value * value % 1000); }
+int add_numbers(int a, int b) { return (a + b); }
+harray<int> nested_numbers;
+int count_nested(int value) { return (hparallel::count(nested_numbers, &odd_number) + value % 2); }
+
+TEST(Threading_parallel)
+{
+	hthreadpool pool(3);
+	hparallel::setThreadPool(&pool);
+	int minimumSize = hparallel::getMinimumSize();
+	hparallel::setMinimumSize(1000);
+	// many equal keys make sure the merge is stable
+	harray<SortEntry> entries;
+	for (int i = 0; i < 100000; i++)
+	{
+		entries += SortEntry(hrand(100), i);
+	}
+	harray<SortEntry> sorted = entries.sorted(&sort_entry_less);
+	hparallel::sort(entries, &sort_entry_less);
+	bool equal = true;
+	for (int i = 0; i < entries.size(); i++)
+	{
+		equal = equal && (entries[i].key == sorted[i].key && entries[i].index == sorted[i].index);
+	}
+	CHECK(equal);
+	harray<int> a;
+	for (int i = 0; i < 100000; i++)
+	{
+		a += i;
+	}
+	harray<int> b = hparallel::randomized(a);
+	CHECK(b.size() == a.size());
+	CHECK(b != a);
+	CHECK(hparallel::sorted(b) == a);
+	CHECK(hparallel::find_all(a, &odd_number) == a.find_all(&odd_number));
+	CHECK(hparallel::count(a, &odd_number) == 50000);
+	harray<int> c = hparallel::map(a, &square_number);
+	CHECK(c.size() == a.size());
+	CHECK(c[999] == square_number(999));
+	int sum = 5;
+	foreach (int, it, c)
+	{
+		sum += (*it);
+	}
+	CHECK(hparallel::reduce(c, &add_numbers, 5) == sum);
+	CHECK(hparallel::reduce(harray<int>(), &add_numbers, 5) == 5);
+	// parallel algorithms called from parts that already run on the pool
+	nested_numbers = a(0, 2000);
+	harray<int> d = hparallel::map(a(0, 2000), &count_nested);
+	CHECK(d.size() == 2000);
+	CHECK(d[0] == 1000 && d[1] == 1001 && d[1999] == 1001);
+	nested_numbers.clear();
+	hparallel::setMinimumSize(minimumSize);
+	hparallel::setThreadPool(NULL);
+}
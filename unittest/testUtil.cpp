@@ -17,7 +17,9 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include <hltypes/hcrc32.h>
 #include <hltypes/hltypesUtil.h>
+#include <hltypes/hstream.h>
 #include <hltypes/hstring.h>
 
 TEST(Util_hrand)
@@ -221,3 +223,28 @@ TEST(Util_ranges)
 	CHECK(!is_inside(10.0001f, -5.0f, 10.0f));
 }
 
+
+TEST(Util_crc32)
+{
+	unsigned char text[] = "123456789";
+	CHECK(calc_crc32(text, 9) == 0xCBF43926);
+	CHECK(calc_crc32(text, 0) == 0);
+	unsigned char data[1000];
+	for (int i = 0; i < 1000; i++)
+	{
+		data[i] = (unsigned char)(i * 7 + i / 13);
+	}
+	unsigned int value = calc_crc32(data, 1000);
+	hcrc32 crc;
+	crc.update(data, 1);
+	crc.update(&data[1], 500);
+	crc.update(&data[501], 499);
+	CHECK(crc.final() == value);
+	crc.reset();
+	crc.update(text, 9);
+	CHECK(crc.final() == 0xCBF43926);
+	hstream stream;
+	stream.write_raw(data, 1000);
+	stream.rewind();
+	CHECK(calc_crc32(&stream) == value);
+}